@@ -0,0 +1,156 @@
+// Micro-benchmarks of the SceneTree indexes. The same source is built against the library as
+// configured (flat hash map indexes) and against the SCENETREE_STD_HASH_MAPS build, whose
+// indexes are std::unordered_map, so the two executables can be compared side by side:
+//
+//   index_benchmarks_flat [sizes...]
+//   index_benchmarks_std  [sizes...]
+//
+// Sizes default to 10000 100000 1000000 nodes.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "SceneTree/SceneTree.h"
+
+#ifdef SCENETREE_STD_HASH_MAPS
+static const char* kVariant = "std::unordered_map";
+#else
+static const char* kVariant = "FlatHashMap";
+#endif
+
+static constexpr uint32_t kTagCount = 64;
+static constexpr uint32_t kFanOut = 8;
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps results alive so the optimizer cannot drop the measured work
+static volatile uintptr_t g_sink;
+
+static double elapsedNs(Clock::time_point start) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+}
+
+static void report(const char* name, size_t nodes, double nsPerOp) {
+    std::printf("%-20s %-18s %9zu nodes %12.1f ns/op\n", kVariant, name, nodes, nsPerOp);
+}
+
+// Ids 1..count, each node the child of node (id - 2) / kFanOut + 1
+static Scene makeScene(uint32_t count) {
+    Scene scene("Benchmark");
+    scene.reserve(count);
+    scene.addObject(1, "Root");
+    for (uint32_t id = 2; id <= count; ++id) {
+        scene.addObject(id, "Node" + std::to_string(id % 1024), ObjectStatus::Active, (id - 2) / kFanOut + 1);
+    }
+    return scene;
+}
+
+static void benchCreateFromScene(const Scene& scene, uint32_t count) {
+    const int runs = count <= 100000 ? 5 : 1;
+    double best = 0;
+    for (int run = 0; run < runs; ++run) {
+        auto start = Clock::now();
+        auto tree = SceneTree::createFromScene(scene);
+        double ns = elapsedNs(start);
+        g_sink = reinterpret_cast<uintptr_t>(tree.get());
+        best = run == 0 ? ns : std::min(best, ns);
+    }
+    report("createFromScene", count, best / count);
+}
+
+static void benchFindNode(SceneTree& tree, uint32_t count) {
+    constexpr size_t kLookups = 2000000;
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<uint32_t> pick(1, count);
+    std::vector<ObjectId> ids(kLookups);
+    for (auto& id : ids) id = pick(rng);
+
+    uintptr_t sum = 0;
+    auto start = Clock::now();
+    for (ObjectId id : ids) sum += reinterpret_cast<uintptr_t>(tree.findNode(id));
+    double ns = elapsedNs(start);
+    g_sink = sum;
+    report("findNode", count, ns / kLookups);
+}
+
+// Resolving a batch of random ids and reading each node, as a gameplay system does: the scalar
+// findNode loop against findNodes
+static void benchFindNodes(SceneTree& tree, uint32_t count) {
+    constexpr size_t kBatch = 4096;
+    constexpr size_t kBatches = 500;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<uint32_t> pick(1, count);
+    std::vector<ObjectId> ids(kBatch * kBatches);
+    for (auto& id : ids) id = pick(rng);
+    std::vector<SceneNode*> out(kBatch);
+
+    // Alternating runs, best of each, to keep machine noise out of the comparison
+    uintptr_t sum = 0;
+    double scalar = 0, batched = 0;
+    for (int run = 0; run < 5; ++run) {
+        auto start = Clock::now();
+        for (size_t b = 0; b < kBatches; ++b) {
+            for (size_t i = 0; i < kBatch; ++i) out[i] = tree.findNode(ids[b * kBatch + i]);
+            for (SceneNode* node : out) sum += static_cast<uintptr_t>(node->getStatus());
+        }
+        double ns = elapsedNs(start);
+        scalar = run == 0 ? ns : std::min(scalar, ns);
+
+        start = Clock::now();
+        for (size_t b = 0; b < kBatches; ++b) {
+            tree.findNodes(Span<const ObjectId>(ids.data() + b * kBatch, kBatch), out);
+            for (SceneNode* node : out) sum += static_cast<uintptr_t>(node->getStatus());
+        }
+        ns = elapsedNs(start);
+        batched = run == 0 ? ns : std::min(batched, ns);
+    }
+    report("findNode loop", count, scalar / ids.size());
+    report("findNodes batch", count, batched / ids.size());
+    g_sink = sum;
+}
+
+static void benchFindAllNodesByTag(SceneTree& tree, uint32_t count) {
+    std::vector<StringAtom> tags;
+    for (uint32_t i = 0; i < kTagCount; ++i) tags.push_back(StringAtom::intern("Tag" + std::to_string(i)));
+    for (uint32_t id = 1; id <= count; ++id) tree.findNode(id)->addTag(tags[id % kTagCount]);
+    tree.processEvents();
+
+    // Bucket lookup alone, and the lookup plus copying the bucket out
+    constexpr size_t kLookups = 2000000;
+    uintptr_t sum = 0;
+    auto start = Clock::now();
+    for (size_t i = 0; i < kLookups; ++i) sum += tree.nodesByTag(tags[i % kTagCount]).size();
+    report("nodesByTag", count, elapsedNs(start) / kLookups);
+
+    const size_t copies = std::max<size_t>(kTagCount, 20000000 / count);
+    std::vector<SceneNode*> out;
+    start = Clock::now();
+    for (size_t i = 0; i < copies; ++i) {
+        out.clear();
+        tree.findAllNodesByTag(tags[i % kTagCount], out);
+        sum += out.size();
+    }
+    report("findAllNodesByTag", count, elapsedNs(start) / copies);
+    g_sink = sum;
+}
+
+int main(int argc, char** argv) {
+    std::vector<uint32_t> sizes;
+    for (int i = 1; i < argc; ++i) sizes.push_back(static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10)));
+    if (sizes.empty()) sizes = {10000, 100000, 1000000};
+
+    for (uint32_t count : sizes) {
+        if (count == 0) continue;
+        Scene scene = makeScene(count);
+        benchCreateFromScene(scene, count);
+        auto tree = SceneTree::createFromScene(scene);
+        benchFindNode(*tree, count);
+        benchFindNodes(*tree, count);
+        benchFindAllNodesByTag(*tree, count);
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Save/load benchmarks of every SceneFormat. For each scene size, the same tree is saved in
+// each format, then loaded back (auto-detected), and the file size and both times are printed:
+//
+//   io_benchmarks [sizes...] [--diamonds <levels>]... [--dir <directory>]
+//
+// Sizes default to 10000 100000 1000000 nodes. A second run saves and loads stacked diamonds
+// (a DAG whose depth grows with its size, and whose every level has a shared node) at each
+// --diamonds level count, 1000 2000 4000 by default, to show that load time stays linear in
+// depth. Only the encodings marked 'deep' take part. Files are written to the current directory (or --dir) and removed afterwards.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "SceneTree/SceneIO.h"
+#include "SceneTree/SceneTree.h"
+
+namespace fs = std::filesystem;
+
+static constexpr uint32_t kTagCount = 64;
+static constexpr uint32_t kFanOut = 8;
+
+using Clock = std::chrono::steady_clock;
+
+static double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+struct Encoding {
+    SceneFormat format;
+    const char* name;
+    const char* extension;
+    // False where depth alone is costly: indentation makes pretty JSON quadratic in depth, the
+    // BSON encoder re-measures every enclosing document, and nlohmann's UBJSON reader recurses
+    // once per nesting level and overflows the stack a few thousand levels down
+    bool deep;
+};
+
+static const Encoding kEncodings[] = {
+    {SceneFormat::Json, "Json", "json", false},
+    {SceneFormat::CompactJson, "CompactJson", "json", true},
+    {SceneFormat::Cbor, "Cbor", "cbor", true},
+    {SceneFormat::MessagePack, "MessagePack", "msgpack", true},
+    {SceneFormat::Ubjson, "Ubjson", "ubj", false},
+    {SceneFormat::Bson, "Bson", "bson", false},
+    {SceneFormat::Binary, "Binary", "scnb", true},
+};
+
+// Ids 1..count, each node the child of node (id - 2) / kFanOut + 1, with one tag per node and
+// every 16th node hidden so that every serialized property is exercised
+static std::unique_ptr<SceneTree> makeTree(uint32_t count) {
+    Scene scene("Benchmark");
+    scene.reserve(count);
+    scene.addObject(1, "Root");
+    for (uint32_t id = 2; id <= count; ++id) {
+        scene.addObject(id, "Node" + std::to_string(id % 1024), ObjectStatus::Active, (id - 2) / kFanOut + 1);
+    }
+    auto tree = SceneTree::createFromScene(scene);
+
+    std::vector<StringAtom> tags;
+    for (uint32_t i = 0; i < kTagCount; ++i) tags.push_back(StringAtom::intern("Tag" + std::to_string(i)));
+    for (uint32_t id = 1; id <= count; ++id) {
+        SceneNode* node = tree->findNode(id);
+        node->addTag(tags[id % kTagCount]);
+        if (id % 16 == 0) node->setVisible(false);
+    }
+    return tree;
+}
+
+// 'levels' stacked diamonds: each level's top has two children that share one bottom node,
+// which is the next level's top. Built top-down, 3 * levels + 1 nodes.
+static std::unique_ptr<SceneTree> makeDiamonds(uint32_t levels) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    SceneNode* top = root.get();
+    uint32_t nextId = 2;
+    for (uint32_t level = 0; level < levels; ++level) {
+        auto left = std::make_shared<SceneNode>(nextId++, "Left");
+        auto right = std::make_shared<SceneNode>(nextId++, "Right");
+        auto bottom = std::make_shared<SceneNode>(nextId++, "Bottom");
+        top->addChild(left);
+        top->addChild(right);
+        left->addChild(bottom);
+        right->addChild(bottom);
+        top = bottom.get();
+    }
+    return std::make_unique<SceneTree>(root);
+}
+
+static void benchEncoding(const SceneTree& tree, uint32_t count, const Encoding& encoding, const fs::path& dir) {
+    const int runs = count <= 100000 ? 5 : 1;
+    const fs::path path = dir / ("io_benchmark." + std::string(encoding.extension));
+    double bestSave = 0;
+    double bestLoad = 0;
+    for (int run = 0; run < runs; ++run) {
+        auto start = Clock::now();
+        if (!SceneIO::saveSceneTree(tree, path.string(), encoding.format)) {
+            std::fprintf(stderr, "%s: save failed\n", encoding.name);
+            return;
+        }
+        double save = elapsedMs(start);
+
+        start = Clock::now();
+        auto loaded = SceneIO::loadSceneTree(path.string());
+        double load = elapsedMs(start);
+        if (!loaded || loaded->getRoot()->getId() != tree.getRoot()->getId()) {
+            std::fprintf(stderr, "%s: load failed\n", encoding.name);
+            return;
+        }
+        bestSave = run == 0 ? save : std::min(bestSave, save);
+        bestLoad = run == 0 ? load : std::min(bestLoad, load);
+    }
+
+    const double mb = static_cast<double>(fs::file_size(path)) / (1024.0 * 1024.0);
+    std::printf("%-12s %9u nodes %10.2f MB %10.1f ms save %10.1f ms load\n", encoding.name, count, mb,
+                bestSave, bestLoad);
+    fs::remove(path);
+}
+
+int main(int argc, char** argv) {
+    std::vector<uint32_t> sizes;
+    std::vector<uint32_t> diamondLevels;
+    fs::path dir = fs::current_path();
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--dir") == 0 && i + 1 < argc) {
+            dir = argv[++i];
+        } else if (std::strcmp(argv[i], "--diamonds") == 0 && i + 1 < argc) {
+            diamondLevels.push_back(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10)));
+        } else {
+            sizes.push_back(static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10)));
+        }
+    }
+    if (sizes.empty()) sizes = {10000, 100000, 1000000};
+    if (diamondLevels.empty()) diamondLevels = {1000, 2000, 4000};
+
+    for (uint32_t count : sizes) {
+        if (count == 0) continue;
+        auto tree = makeTree(count);
+        for (const Encoding& encoding : kEncodings) benchEncoding(*tree, count, encoding, dir);
+    }
+
+    std::printf("\nStacked diamonds\n");
+    for (uint32_t levels : diamondLevels) {
+        if (levels == 0) continue;
+        auto tree = makeDiamonds(levels);
+        for (const Encoding& encoding : kEncodings) {
+            if (encoding.deep) benchEncoding(*tree, 3 * levels + 1, encoding, dir);
+        }
+    }
+    return 0;
+}
@@ -163,8 +163,9 @@ int main() {
             std::cout << "\n---- Demonstrating Property Listeners ----" << std::endl;
             
             // Register a listener for status changes
-            active_tree->addPropertyListener(NodeProperty::Status, [](SceneNode* node, NodeProperty prop, const std::any& oldVal, const std::any& newVal) {
-                std::cout << "[Listener] Node '" << node->getName() << "' (ID: " << node->getId() << ") changed status." << std::endl;
+            active_tree->addPropertyListener<NodeProperty::Status>([](SceneNode* node, ObjectStatus oldStatus, ObjectStatus newStatus) {
+                std::cout << "[Listener] Node '" << node->getName() << "' (ID: " << node->getId() << ") changed status: "
+                          << oldStatus << " -> " << newStatus << std::endl;
             });
 
             if (player_node) {
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "SceneTree/SceneNode.h"
+
+// What a journal record describes
+enum class ChangeKind : uint8_t {
+    Property, // A property change as delivered to listeners ('property', 'oldVal', 'newVal')
+    Attach,   // SceneTree::attach: 'node' is the parent, 'newVal' the id of the attached root
+    Detach    // SceneTree::detach: 'node' is the parent, 'oldVal' the id of the detached root
+};
+
+struct ChangeRecord {
+    uint64_t sequence = 0;
+    ObjectId node;
+    ChangeKind kind = ChangeKind::Property;
+    NodeProperty property = NodeProperty::Hierarchy;
+    PropertyValue oldVal;
+    PropertyValue newVal;
+};
+
+// Fixed-capacity ring of change records with monotonically increasing sequence numbers
+// (starting at 1). One writer appends; any number of readers on any thread tail it with
+// readSince() without locking. Every slot is a seqlock over three 64-bit words, so a reader
+// that races with the writer overwriting a slot detects it and reports the loss instead of
+// returning a torn record.
+class ChangeJournal {
+public:
+    // 'capacity' is rounded up to a power of two (at least 2)
+    explicit ChangeJournal(size_t capacity);
+
+    size_t capacity() const { return m_mask + 1; }
+    // Sequence number of the newest record, 0 if nothing was recorded yet
+    uint64_t lastSequence() const { return m_next.load(std::memory_order_acquire) - 1; }
+
+    // Single writer only (calls must not overlap)
+    void record(ObjectId node, ChangeKind kind, NodeProperty property, const PropertyValue& oldVal,
+                const PropertyValue& newVal);
+
+    // Appends the records with a sequence number greater than 'after' to 'out', oldest first,
+    // at most 'maxRecords' of them. Returns false if some of those records were already
+    // overwritten: the consumer fell behind and has to resynchronize (e.g. re-serialize the
+    // tree). The records that are still available are appended either way.
+    bool readSince(uint64_t after, std::vector<ChangeRecord>& out,
+                   size_t maxRecords = std::numeric_limits<size_t>::max()) const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> stamp{0}; // Sequence number stored in the slot, 0 while it is written
+        std::atomic<uint64_t> header{0}; // node id | property | kind | value types
+        std::atomic<uint64_t> values{0}; // old bits | new bits
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+    std::atomic<uint64_t> m_next{1};
+};
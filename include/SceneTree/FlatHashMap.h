@@ -0,0 +1,337 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+// Asks the CPU to start loading 'address' into the cache; a no-op where no hint is available
+inline void prefetchRead(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    (void)address;
+#endif
+}
+
+// Open-addressing hash map with Robin Hood linear probing and backward-shift deletion.
+// Entries live inline in one array (no per-entry allocation), and a parallel byte array holds
+// each slot's probe distance, so a lookup touches one or two cache lines instead of chasing a
+// bucket list. The hash picks a block of 16 slots through a Fibonacci multiply and the slot in
+// it through its low bits: identity hashes of ids (std::hash<unsigned>) spread evenly over the
+// power-of-two table even when strided, while runs of consecutive ids stay next to each other.
+//
+// Differences from std::unordered_map: any insertion may move entries, so it invalidates
+// iterators, pointers and references into the map; erase() may move later entries back by one
+// (an entry that wrapped around the end can then be visited twice, none is skipped). Probe
+// distances are kept in a byte, so the hash must not send more than ~250 keys to one value.
+template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+class FlatHashMap {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using size_type = size_t;
+
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+        Iterator() = default;
+        template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+        Iterator(const Iterator<OtherConst>& other) : m_map(other.m_map), m_index(other.m_index) {}
+
+        reference operator*() const { return m_map->m_slots[m_index].value; }
+        pointer operator->() const { return &m_map->m_slots[m_index].value; }
+        Iterator& operator++() {
+            ++m_index;
+            skipEmpty();
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const Iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const Iterator& other) const { return m_index != other.m_index; }
+
+    private:
+        friend class FlatHashMap;
+        template <bool> friend class Iterator;
+        using Map = std::conditional_t<Const, const FlatHashMap, FlatHashMap>;
+
+        Iterator(Map* map, size_t index) : m_map(map), m_index(index) {}
+        void skipEmpty() {
+            while (m_index < m_map->m_capacity && m_map->m_dist[m_index] == 0) ++m_index;
+        }
+
+        Map* m_map = nullptr;
+        size_t m_index = 0;
+    };
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() = default;
+    FlatHashMap(const FlatHashMap& other) { copyFrom(other); }
+    FlatHashMap(FlatHashMap&& other) noexcept { swap(other); }
+    FlatHashMap& operator=(const FlatHashMap& other) {
+        if (this != &other) {
+            FlatHashMap copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+    FlatHashMap& operator=(FlatHashMap&& other) noexcept {
+        if (this != &other) {
+            FlatHashMap moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+    ~FlatHashMap() { destroyAll(); }
+
+    void swap(FlatHashMap& other) noexcept {
+        std::swap(m_slots, other.m_slots);
+        std::swap(m_dist, other.m_dist);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_size, other.m_size);
+        std::swap(m_shift, other.m_shift);
+    }
+
+    iterator begin() {
+        iterator it(this, 0);
+        if (m_capacity) it.skipEmpty();
+        return it;
+    }
+    const_iterator begin() const {
+        const_iterator it(this, 0);
+        if (m_capacity) it.skipEmpty();
+        return it;
+    }
+    iterator end() { return iterator(this, m_capacity); }
+    const_iterator end() const { return const_iterator(this, m_capacity); }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator find(const K& key) { return iterator(this, findIndex(key)); }
+    const_iterator find(const K& key) const { return const_iterator(this, findIndex(key)); }
+    size_t count(const K& key) const { return findIndex(key) != m_capacity ? 1 : 0; }
+
+    // Prefetches the slot where a lookup of 'key' starts probing; batch lookups issue this a
+    // few keys ahead so the misses overlap
+    void prefetch(const K& key) const {
+        if (m_size == 0) return;
+        size_t index = homeIndex(key);
+        prefetchRead(&m_dist[index]);
+        prefetchRead(&m_slots[index]);
+    }
+
+    V& at(const K& key) {
+        size_t index = findIndex(key);
+        if (index == m_capacity) throw std::out_of_range("FlatHashMap::at");
+        return m_slots[index].value.second;
+    }
+    const V& at(const K& key) const { return const_cast<FlatHashMap*>(this)->at(key); }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+        size_t index = findIndex(key);
+        if (index != m_capacity) return {iterator(this, index), false};
+        if ((m_size + 1) * 8 > m_capacity * 7) grow();
+        index = insertEntry(value_type(std::piecewise_construct, std::forward_as_tuple(key),
+                                       std::forward_as_tuple(std::forward<Args>(args)...)));
+        return {iterator(this, index), true};
+    }
+    template <typename M>
+    std::pair<iterator, bool> emplace(const K& key, M&& value) {
+        return try_emplace(key, std::forward<M>(value));
+    }
+    std::pair<iterator, bool> insert(const value_type& entry) { return try_emplace(entry.first, entry.second); }
+    V& operator[](const K& key) { return try_emplace(key).first->second; }
+
+    // Returns the iterator following the erased entry
+    iterator erase(const_iterator pos) {
+        size_t index = pos.m_index;
+        destroySlot(index);
+        // Backward shift: pull the following entries one step closer to their home slot
+        const size_t mask = m_capacity - 1;
+        size_t hole = index;
+        size_t next = (hole + 1) & mask;
+        while (m_dist[next] > 1) {
+            new (&m_slots[hole].value) value_type(std::move(m_slots[next].value));
+            m_dist[hole] = static_cast<uint8_t>(m_dist[next] - 1);
+            m_slots[next].value.~value_type();
+            m_dist[next] = 0;
+            hole = next;
+            next = (next + 1) & mask;
+        }
+        iterator it(this, index);
+        it.skipEmpty();
+        return it;
+    }
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+    size_t erase(const K& key) {
+        size_t index = findIndex(key);
+        if (index == m_capacity) return 0;
+        erase(const_iterator(this, index));
+        return 1;
+    }
+
+    void clear() {
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (m_dist[i]) destroySlot(i);
+        }
+    }
+
+    // Makes room for 'count' entries without further rehashing
+    void reserve(size_t count) {
+        size_t capacity = kMinCapacity;
+        while (capacity * 7 < count * 8) capacity <<= 1;
+        if (capacity > m_capacity) rehash(capacity);
+    }
+
+private:
+    static constexpr size_t kMinCapacity = 32; // Keeps the block shift below 64
+    static constexpr uint8_t kMaxDistance = 255;
+    static constexpr uint32_t kBlockBits = 4;
+    static constexpr uint64_t kBlockMask = (1u << kBlockBits) - 1;
+
+    // Uninitialized storage for one entry; occupied when m_dist is non-zero
+    union Slot {
+        Slot() {}
+        ~Slot() {}
+        value_type value;
+    };
+
+    size_t homeIndex(const K& key) const {
+        const uint64_t hash = Hash{}(key);
+        const uint64_t block = ((hash >> kBlockBits) * 0x9E3779B97F4A7C15ull) >> (m_shift + kBlockBits);
+        return static_cast<size_t>((block << kBlockBits) | (hash & kBlockMask));
+    }
+
+    // Index of 'key', or m_capacity if absent
+    size_t findIndex(const K& key) const {
+        if (m_size == 0) return m_capacity;
+        const size_t mask = m_capacity - 1;
+        size_t index = homeIndex(key);
+        for (uint32_t distance = 1;; ++distance, index = (index + 1) & mask) {
+            // An empty slot or a richer entry ends the probe: Robin Hood keeps runs ordered
+            if (m_dist[index] < distance) return m_capacity;
+            if (m_dist[index] == distance && KeyEqual{}(m_slots[index].value.first, key)) return index;
+        }
+    }
+
+    // Places a new entry and returns its index. Entries closer to home than the one being
+    // placed are displaced further along ("take from the rich").
+    size_t insertEntry(value_type&& entry) {
+        const K key = entry.first;
+        size_t placed = m_capacity;
+        bool grew = false;
+        for (;;) {
+            const size_t mask = m_capacity - 1;
+            size_t index = homeIndex(entry.first);
+            uint8_t distance = 1;
+            for (;; ++distance, index = (index + 1) & mask) {
+                if (m_dist[index] == 0) {
+                    new (&m_slots[index].value) value_type(std::move(entry));
+                    m_dist[index] = distance;
+                    ++m_size;
+                    if (grew) return findIndex(key);
+                    return placed != m_capacity ? placed : index;
+                }
+                if (m_dist[index] < distance) {
+                    std::swap(entry, m_slots[index].value);
+                    std::swap(distance, m_dist[index]);
+                    if (placed == m_capacity) placed = index;
+                }
+                if (distance == kMaxDistance) break;
+            }
+            // Pathological probe length: grow and keep placing the entry in hand
+            grow();
+            grew = true;
+        }
+    }
+
+    void grow() { rehash(m_capacity ? m_capacity * 2 : kMinCapacity); }
+
+    void rehash(size_t capacity) {
+        std::unique_ptr<Slot[]> oldSlots = std::move(m_slots);
+        std::unique_ptr<uint8_t[]> oldDist = std::move(m_dist);
+        size_t oldCapacity = m_capacity;
+
+        m_slots.reset(new Slot[capacity]);
+        m_dist.reset(new uint8_t[capacity]());
+        m_capacity = capacity;
+        m_size = 0;
+        m_shift = 64;
+        for (size_t c = capacity; c > 1; c >>= 1) --m_shift;
+
+        for (size_t i = 0; i < oldCapacity; ++i) {
+            if (!oldDist[i]) continue;
+            insertEntry(std::move(oldSlots[i].value));
+            oldSlots[i].value.~value_type();
+        }
+    }
+
+    void destroySlot(size_t index) {
+        m_slots[index].value.~value_type();
+        m_dist[index] = 0;
+        --m_size;
+    }
+
+    void destroyAll() {
+        clear();
+        m_slots.reset();
+        m_dist.reset();
+        m_capacity = 0;
+    }
+
+    void copyFrom(const FlatHashMap& other) {
+        if (!other.m_capacity) return;
+        m_slots.reset(new Slot[other.m_capacity]);
+        m_dist.reset(new uint8_t[other.m_capacity]());
+        m_capacity = other.m_capacity;
+        m_shift = other.m_shift;
+        for (size_t i = 0; i < m_capacity; ++i) {
+            if (!other.m_dist[i]) continue;
+            new (&m_slots[i].value) value_type(other.m_slots[i].value);
+            m_dist[i] = other.m_dist[i];
+            ++m_size;
+        }
+    }
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::unique_ptr<uint8_t[]> m_dist; // Probe distance + 1 of each slot's entry, 0 when empty
+    size_t m_capacity = 0;             // Power of two, or 0 before the first insertion
+    size_t m_size = 0;
+    uint32_t m_shift = 64;
+};
+
+// Map type of the hot SceneTree and Scene indexes. Defining SCENETREE_STD_HASH_MAPS switches
+// them back to std::unordered_map, which the index benchmarks use as their baseline.
+#ifdef SCENETREE_STD_HASH_MAPS
+template <typename K, typename V, typename Hash = std::hash<K>>
+using IndexMap = std::unordered_map<K, V, Hash>;
+#else
+template <typename K, typename V, typename Hash = std::hash<K>>
+using IndexMap = FlatHashMap<K, V, Hash>;
+#endif
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "SceneTree/SceneNode.h"
+#include "SceneTree/Span.h"
+#include "SceneTree/TagMask.h"
+
+class SceneTree;
+
+// Bit of 'status' in LiveQuerySpec::statuses
+constexpr uint32_t statusBit(ObjectStatus status) {
+    return 1u << static_cast<uint32_t>(status);
+}
+
+// What a LiveQuery selects: nodes carrying every 'include' tag and no 'exclude' tag, whose
+// status is in 'statuses', and, if 'scope' is set, that are reachable from the scope node
+// (which counts as part of its own scope).
+struct LiveQuerySpec {
+    static constexpr uint32_t kAnyStatus = 0xFFFFFFFFu;
+
+    std::vector<StringAtom> include;
+    std::vector<StringAtom> exclude;
+    uint32_t statuses = kAnyStatus;
+    std::optional<ObjectId> scope;
+};
+
+// Result set of a query that a SceneTree keeps up to date as tags, statuses and the hierarchy
+// change (see SceneTree::createLiveQuery). Members are stored densely; each change moves at
+// most one entry, so reading the set every frame costs nothing beyond the iteration.
+class LiveQuery {
+public:
+    LiveQuery(const LiveQuery&) = delete;
+    LiveQuery& operator=(const LiveQuery&) = delete;
+
+    const LiveQuerySpec& getSpec() const { return m_spec; }
+
+    // Current members, in no particular order. The span stays valid until the next change to
+    // the tree. Empty once the tree is gone.
+    NodeSpan nodes() const;
+    size_t size() const { return nodes().size(); }
+    bool contains(const SceneNode* node) const;
+
+private:
+    friend class SceneTree;
+    LiveQuery(const SceneTree* tree, LiveQuerySpec spec) : m_tree(tree), m_spec(std::move(spec)) {}
+
+    // Adds or removes 'node' in O(1); removal swaps the last member into its place
+    void setMember(SceneNode* node, bool member);
+    void clear();
+
+    const SceneTree* m_tree; // Null once the tree is destroyed
+    LiveQuerySpec m_spec;
+    TagQuery m_query;        // 'include'/'exclude' against the tree's TagRegistry
+    std::vector<SceneNode*> m_nodes;
+    std::unordered_map<ObjectId, uint32_t> m_positions; // Index into m_nodes
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "SceneTree/Span.h"
+
+class SceneNode;
+
+// The nodes that share one name or tag in a SceneTree index.
+// Entries are dense, so a bucket can be handed out as a NodeSpan, and removal is O(1) by
+// swap-remove: the owner remembers each entry's position (its back-index) and is told whose
+// entry moved into the gap. Dense order is therefore arbitrary. "First" has an explicit policy
+// instead: a doubly linked list threaded through the entries keeps insertion order, and
+// first() is the oldest entry still in the bucket.
+class NodeBucket {
+public:
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+    // Appends 'node' (the newest entry) and returns its position. 'owner' is an opaque tag
+    // reported back by erase() when the entry moves; SceneTree uses the node's slot.
+    uint32_t insert(SceneNode* node, uint32_t owner);
+    // Removes the entry at 'position'. Returns the owner of the entry that was moved into
+    // 'position', or kNone if the removed entry was the last one.
+    uint32_t erase(uint32_t position);
+    void setOwner(uint32_t position, uint32_t owner) { m_links[position].owner = owner; }
+
+    SceneNode* at(uint32_t position) const { return m_nodes[position]; }
+    size_t size() const { return m_nodes.size(); }
+    bool empty() const { return m_nodes.empty(); }
+    // Dense view, in no particular order
+    NodeSpan nodes() const { return m_nodes; }
+
+    // Insertion order: for (uint32_t p = head(); p != kNone; p = next(p)) ... at(p)
+    SceneNode* first() const { return m_head != kNone ? m_nodes[m_head] : nullptr; }
+    uint32_t head() const { return m_head; }
+    uint32_t next(uint32_t position) const { return m_links[position].next; }
+
+private:
+    struct Link {
+        uint32_t owner;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    std::vector<SceneNode*> m_nodes;
+    std::vector<Link> m_links; // Parallel to m_nodes
+    uint32_t m_head = kNone;
+    uint32_t m_tail = kNone;
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "SceneTree/SceneNode.h"
+
+using PropertyListener = std::function<void(SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&)>;
+
+// Identifies one registered listener. Handles are generation-checked, so removing a listener
+// twice, or after its node left the tree, is a harmless no-op.
+struct ListenerHandle {
+    uint32_t index = 0xFFFFFFFFu;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != 0xFFFFFFFFu; }
+};
+
+// Listener registry of a SceneTree. Each property has a dense array of global listeners and a
+// per-node map; two bitmasks record which of them are non-empty, so dispatching an event
+// nobody listens to costs one bit test. Removal is O(1) (swap-remove through the handle).
+// Listeners may add or remove listeners while being called: additions are first called by
+// the next event, removals take effect at once but are compacted after the dispatch.
+class PropertyListenerTable {
+public:
+    ListenerHandle add(NodeProperty prop, PropertyListener listener);
+    ListenerHandle add(ObjectId id, NodeProperty prop, PropertyListener listener);
+    bool remove(ListenerHandle handle);
+    bool contains(ListenerHandle handle) const;
+    // Drops every node-specific listener of 'id'
+    void removeNode(ObjectId id);
+
+    bool hasListeners(NodeProperty prop) const {
+        return ((m_global_mask | m_node_mask) & static_cast<uint32_t>(prop)) != 0;
+    }
+    void dispatch(SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal);
+
+private:
+    static constexpr size_t kPropertyCount = 7; // Bits of NodeProperty
+
+    // One dispatch entry; the listener itself lives in its record so its address is stable
+    struct Entry {
+        PropertyListener* listener;
+        uint32_t record;
+    };
+    using EntryList = std::vector<Entry>;
+
+    struct Record {
+        std::unique_ptr<PropertyListener> listener; // Null while the record is free
+        uint32_t generation = 0;
+        uint32_t position = 0;  // Index into its EntryList
+        uint8_t property = 0;   // Index into the per-property arrays
+        bool global = true;
+        bool erasing = false;   // Removed during a dispatch; erased when it ends
+        ObjectId node;
+    };
+
+    ListenerHandle insert(NodeProperty prop, bool global, ObjectId id, PropertyListener listener);
+    EntryList* entriesOf(const Record& record);
+    void detachRecord(uint32_t recordIndex);
+    void erase(uint32_t recordIndex);
+    void updateMasks(uint8_t property);
+
+    std::array<EntryList, kPropertyCount> m_global;
+    std::array<std::unordered_map<ObjectId, EntryList>, kPropertyCount> m_by_node;
+    uint32_t m_global_mask = 0;
+    uint32_t m_node_mask = 0;
+
+    std::vector<Record> m_records;
+    std::vector<uint32_t> m_free_records;
+    // Per node, the records of its node-specific listeners (for removeNode)
+    std::unordered_map<ObjectId, std::vector<uint32_t>> m_node_records;
+
+    uint32_t m_dispatch_depth = 0;
+    std::vector<uint32_t> m_deferred; // Removed during a dispatch, erased when it ends
+};
+
+// RAII owner of a listener registration: the listener is removed when the subscription is
+// destroyed or reset. It may outlive the tree, in which case it does nothing.
+class PropertySubscription {
+public:
+    PropertySubscription() = default;
+    PropertySubscription(std::weak_ptr<PropertyListenerTable> table, ListenerHandle handle)
+        : m_table(std::move(table)), m_handle(handle) {}
+    PropertySubscription(PropertySubscription&& other) noexcept;
+    PropertySubscription& operator=(PropertySubscription&& other) noexcept;
+    PropertySubscription(const PropertySubscription&) = delete;
+    PropertySubscription& operator=(const PropertySubscription&) = delete;
+    ~PropertySubscription() { reset(); }
+
+    // Removes the listener now
+    void reset();
+    // Gives up ownership; the listener stays registered
+    ListenerHandle release();
+    // False once the listener is gone (reset, its node left the tree, or the tree died)
+    bool isActive() const;
+
+private:
+    std::weak_ptr<PropertyListenerTable> m_table;
+    ListenerHandle m_handle;
+};
@@ -1,15 +1,19 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
 #include <memory>
 #include <vector>
 #include "SceneTree/SceneObject.h"
+#include "SceneTree/FlatHashMap.h"
 
 class Scene {
 public:
     explicit Scene(std::string name);
 
+    // Pre-sizes the object tables for 'count' objects
+    void reserve(size_t count);
+
+    // The returned pointers stay valid until the next addObject or removeObject call
     SceneObject* addObject(ObjectId id, const std::string& name, ObjectStatus status = ObjectStatus::Active, ObjectId parentId = 0);
     SceneObject* getObject(ObjectId id);
     bool removeObject(ObjectId id);
@@ -20,7 +24,7 @@ public:
 
 private:
     std::string m_name;
-    std::unordered_map<ObjectId, SceneObject> m_objects;
+    IndexMap<ObjectId, SceneObject> m_objects;
     std::vector<ObjectId> m_insertion_order;
-    std::unordered_map<ObjectId, ObjectId> m_relationships;
+    IndexMap<ObjectId, ObjectId> m_relationships;
 };
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "SceneTree/SceneTree.h"
+
+// Binary scene format (SceneFormat::Binary). A file is a Header followed by four tightly
+// packed sections:
+//   nodes     Node[nodeCount]        root first, every node before all of its children
+//   children  uint32_t[childCount]   node indices; node i's children are entries
+//                                    [firstChild, firstChild + childCount)
+//   tags      String[tagCount]       node i's tags are entries [firstTag, firstTag + tagCount)
+//   strings   char[stringBytes]      names and tags, unterminated, each distinct string once
+// Every node is stored once, however many parents it has. All fields are 32-bit (or smaller)
+// integers in the byte order of the saving machine, which the header records. A child index
+// is always greater than its parent's, so the loader rejects cycles with one comparison and
+// builds the hierarchy in a single forward pass.
+class SceneBinary {
+public:
+    static constexpr char kMagic[4] = {'S', 'C', 'N', 'B'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kByteOrderMark = 0x01020304u;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t byteOrder; // kByteOrderMark as written by the saving machine
+        uint32_t nodeCount;
+        uint32_t childCount;
+        uint32_t tagCount;
+        uint32_t stringBytes;
+        uint32_t reserved;
+    };
+
+    // A string in the string pool
+    struct String {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    static constexpr uint8_t kHidden = 1u << 0; // Node::flags: the node's visible flag is off
+
+    struct Node {
+        uint32_t id;
+        String name;
+        uint32_t firstChild;
+        uint32_t childCount;
+        uint32_t firstTag;
+        uint32_t tagCount;
+        uint8_t status; // ObjectStatus
+        uint8_t flags;
+        uint16_t reserved;
+    };
+
+    // True if 'data' starts with the binary format's magic bytes
+    static bool isBinary(const void* data, size_t size);
+
+    // Encodes the nodes reachable from the tree's root
+    static std::vector<uint8_t> encode(const SceneTree& tree);
+
+    // Builds a tree from an encoded buffer, typically a MappedFile. Names and tags are interned
+    // straight from the buffer, which need not outlive the call. Returns nullptr (and logs why)
+    // if the buffer is truncated or inconsistent, including node records that no parent lists.
+    static std::unique_ptr<SceneTree> decode(const uint8_t* data, size_t size);
+};
@@ -2,15 +2,37 @@
 
 #include <string>
 #include <memory>
+#include <optional>
 #include "SceneTree/SceneTree.h"
 
+// On-disk scene formats. Loading tells them apart by the file's first bytes.
+// Every format except Binary is the same document (see SceneIO.cpp) in one of the encodings
+// nlohmann_json supports, and is loaded by the same streaming reader.
+enum class SceneFormat {
+    Json,         // Pretty-printed JSON, the default
+    Binary,       // Memory-mappable node table with a string pool (see SceneBinary.h)
+    CompactJson,  // JSON without indentation or line breaks
+    Cbor,         // RFC 8949 Concise Binary Object Representation
+    MessagePack,
+    Ubjson,       // Universal Binary JSON
+    Bson          // BSON as used by MongoDB; the document starts with its own byte length
+};
+
 class SceneIO {
 public:
     // Save a SceneTree to a JSON file
     // Returns true if successful, false otherwise
     static bool saveSceneTree(const SceneTree& tree, const std::string& filepath);
+    static bool saveSceneTree(const SceneTree& tree, const std::string& filepath, SceneFormat format);
 
-    // Load a SceneTree from a JSON file
+    // Load a SceneTree from a file in any SceneFormat
     // Returns a unique_ptr to the loaded SceneTree, or nullptr if loading failed
     static std::unique_ptr<SceneTree> loadSceneTree(const std::string& filepath);
-};
\ No newline at end of file
+    // Same, but reads the file as 'format' instead of detecting it. Json and CompactJson are
+    // read the same way.
+    static std::unique_ptr<SceneTree> loadSceneTree(const std::string& filepath, SceneFormat format);
+
+    // Format of a file judged by its first bytes, or nullopt if it is unreadable or none of them.
+    // Text JSON is always reported as SceneFormat::Json, indented or not.
+    static std::optional<SceneFormat> detectFormat(const std::string& filepath);
+};
@@ -50,6 +50,8 @@ public:
 
     Scene* getScene(const std::string& name);
     SceneTree* getActiveSceneTree() const;
+    // Executor used for async loading; also drives SceneTree::parallelForEach/parallelVisit
+    task_engine::TaskExecutor& getTaskExecutor() const;
     
     // Synchronous Loading and Unloading
     bool preloadScene(const std::string& sceneName, const std::string& filepath);
@@ -3,12 +3,13 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <unordered_set>
 #include <functional>
-#include <any>
 #include <map>
 #include <cstdint>
+#include <type_traits>
 #include "SceneTree/SceneObject.h"
+#include "SceneTree/StringAtom.h"
+#include "SceneTree/SceneTraversal.h"
 
 enum class NodeProperty : uint32_t {
     Name       = 1u << 0,
@@ -38,51 +39,147 @@ inline NodeProperty& operator&=(NodeProperty& lhs, NodeProperty rhs) {
     return lhs;
 }
 
+// Old or new value carried by a property event. Every payload fits in 32 bits, so events are
+// small trivially copyable records that never allocate. Which type is stored follows from the
+// property (see PropertyTraits); a side that does not apply, such as the old value of
+// TagAdded, holds no value.
+class PropertyValue {
+public:
+    enum class Type : uint8_t {
+        None,
+        Atom,   // Name, TagAdded, TagRemoved
+        Status, // Status
+        Id,     // Hierarchy (the child's id)
+        Flag    // Visibility
+    };
+
+    PropertyValue() = default;
+    PropertyValue(StringAtom atom) : m_type(Type::Atom), m_bits(atom.raw()) {}
+    PropertyValue(ObjectStatus status) : m_type(Type::Status), m_bits(static_cast<uint32_t>(status)) {}
+    PropertyValue(ObjectId id) : m_type(Type::Id), m_bits(id.raw()) {}
+    explicit PropertyValue(bool flag) : m_type(Type::Flag), m_bits(flag ? 1u : 0u) {}
+
+    Type type() const { return m_type; }
+    bool has_value() const { return m_type != Type::None; }
+
+    // Raw encoding, for packing values into compact records
+    uint32_t bits() const { return m_bits; }
+    static PropertyValue fromBits(Type type, uint32_t bits) {
+        PropertyValue value;
+        value.m_type = type;
+        value.m_bits = bits;
+        return value;
+    }
+
+    // Returns the stored value, or an empty one (StringAtom::invalid(), ObjectId(), ...) if
+    // nothing of type T is stored
+    template <typename T>
+    T get() const {
+        if constexpr (std::is_same_v<T, StringAtom>) {
+            return m_type == Type::Atom ? StringAtom(m_bits) : StringAtom::invalid();
+        } else if constexpr (std::is_same_v<T, ObjectStatus>) {
+            return m_type == Type::Status ? static_cast<ObjectStatus>(m_bits) : ObjectStatus::Active;
+        } else if constexpr (std::is_same_v<T, ObjectId>) {
+            return m_type == Type::Id ? ObjectId(m_bits) : ObjectId();
+        } else {
+            static_assert(std::is_same_v<T, bool>, "Unsupported property value type");
+            return m_type == Type::Flag && m_bits != 0;
+        }
+    }
+
+    bool operator==(const PropertyValue& other) const { return m_type == other.m_type && m_bits == other.m_bits; }
+    bool operator!=(const PropertyValue& other) const { return !(*this == other); }
+
+private:
+    static_assert(sizeof(ObjectId) <= sizeof(uint32_t), "PropertyValue stores ids in 32 bits");
+
+    Type m_type = Type::None;
+    uint32_t m_bits = 0;
+};
+
+// Value type carried by each property's events, for typed listeners
+template <NodeProperty P> struct PropertyTraits;
+template <> struct PropertyTraits<NodeProperty::Name> { using Value = StringAtom; };
+template <> struct PropertyTraits<NodeProperty::Status> { using Value = ObjectStatus; };
+template <> struct PropertyTraits<NodeProperty::TagAdded> { using Value = StringAtom; };
+template <> struct PropertyTraits<NodeProperty::TagRemoved> { using Value = StringAtom; };
+template <> struct PropertyTraits<NodeProperty::Visibility> { using Value = bool; };
+template <> struct PropertyTraits<NodeProperty::Hierarchy> { using Value = ObjectId; };
+
 class SceneNode;
 
 class INodeObserver {
 public:
     virtual ~INodeObserver() = default;
     virtual void onNodePropertyChanged(SceneNode* node, NodeProperty prop, 
-                                       const std::any& oldVal, const std::any& newVal) = 0;
+                                       const PropertyValue& oldVal, const PropertyValue& newVal) = 0;
 };
 
 class SceneNode : public std::enable_shared_from_this<SceneNode> {
 public:
     SceneNode(ObjectId id, const std::string& name, ObjectStatus status = ObjectStatus::Active);
 
+    SceneNode(ObjectId id, StringAtom name, ObjectStatus status = ObjectStatus::Active);
+
     ObjectId getId() const;
     const std::string& getName() const;
+    StringAtom getNameAtom() const;
     void setName(const std::string& name);
+    void setName(StringAtom name);
     ObjectStatus getStatus() const;
     void setStatus(ObjectStatus status);
+    // The node's own visibility flag (default true). Whether it is actually shown also depends
+    // on its ancestors and status; see SceneTree::isEffectivelyVisible.
+    bool isVisible() const;
+    void setVisible(bool visible);
 
-    // Tag management
+    // Tag management (tags are stored as interned atoms)
     void addTag(const std::string& tag);
+    void addTag(StringAtom tag);
     void removeTag(const std::string& tag);
+    void removeTag(StringAtom tag);
     bool hasTag(const std::string& tag) const;
-    const std::unordered_set<std::string>& getTags() const;
+    bool hasTag(StringAtom tag) const;
+    const std::vector<StringAtom>& getTags() const;
 
     // Dirty Flag System for Batching Optimization
     bool isPropertyDirty(NodeProperty prop) const;
     bool arePropertiesDirty(NodeProperty mask) const;
     void clearDirty();
     const std::string& getCleanName() const;
+    StringAtom getCleanNameAtom() const;
     ObjectStatus getCleanStatus() const;
+    bool getCleanVisible() const;
 
     // Observer mechanism for property changes
     void registerObserver(INodeObserver* observer);
     void unregisterObserver(INodeObserver* observer);
 
+    // Throws std::runtime_error if the child is an ancestor of this node. The check only
+    // expands ancestors that could lead to the child, using a topological rank kept per node.
     void addChild(std::shared_ptr<SceneNode> child);
+    // Adds several children at once; all are validated before any is linked
+    void addChildren(const std::vector<std::shared_ptr<SceneNode>>& children);
     bool removeChild(const std::shared_ptr<SceneNode>& child);
     const std::vector<std::shared_ptr<SceneNode>>& getChildren() const;
 
     std::shared_ptr<SceneNode> findFirstChildNodeByName(const std::string& name) const;
+    std::shared_ptr<SceneNode> findFirstChildNodeByName(StringAtom name) const;
     std::vector<std::shared_ptr<SceneNode>> findAllChildNodesByName(const std::string& name) const;
+    std::vector<std::shared_ptr<SceneNode>> findAllChildNodesByName(StringAtom name) const;
+    // Raw-pointer variants: 'out' is cleared and refilled, so a reused buffer avoids the
+    // allocation and refcounting of the shared_ptr results
+    void findAllChildNodesByName(const std::string& name, std::vector<SceneNode*>& out) const;
+    void findAllChildNodesByName(StringAtom name, std::vector<SceneNode*>& out) const;
 
     const std::vector<std::weak_ptr<SceneNode>>& getParents() const;
 
+    // Non-recursive traversals of the subtree rooted at this node, including the node itself.
+    // VisitOnce yields a shared node only at its first occurrence; AllPaths once per path.
+    PreOrderRange preOrder(VisitMode mode = VisitMode::VisitOnce) const;
+    PostOrderRange postOrder(VisitMode mode = VisitMode::VisitOnce) const;
+    BreadthFirstRange breadthFirst(VisitMode mode = VisitMode::VisitOnce) const;
+
 private:
     friend class SceneTree; // Allow SceneTree to manage parents
 
@@ -90,15 +187,24 @@ private:
     void removeParent(const std::weak_ptr<SceneNode>& parent);
 
     void markDirty(NodeProperty prop);
+    bool hasAncestor(const SceneNode* candidate) const;
+    void orderBefore(SceneNode* child);
+    void raiseRank(int64_t minRank);
 
     ObjectId m_id;
-    std::string m_name;
+    StringAtom m_name;
     ObjectStatus m_status;
     uint32_t m_dirty_flags = 0;
-    std::string m_clean_name;
+    StringAtom m_clean_name;
     ObjectStatus m_clean_status;
-    std::unordered_set<std::string> m_tags;
+    bool m_visible = true;
+    bool m_clean_visible = true;
+    std::vector<StringAtom> m_tags; // Few tags per node: a flat vector beats a hash set
     std::vector<INodeObserver*> m_observers;
     std::vector<std::shared_ptr<SceneNode>> m_children;
     std::vector<std::weak_ptr<SceneNode>> m_parents;
+    // Strictly greater than every parent's rank. Ranks only order nodes, they are not depths:
+    // unlinking never restores them, so repeated relinking lets them drift (by at most one per
+    // link), which 64 bits absorb.
+    int64_t m_topo_rank = 0;
 };
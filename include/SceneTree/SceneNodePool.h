@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+#include "SceneTree/SceneObject.h"
+#include "SceneTree/StringAtom.h"
+
+class SceneNode;
+
+// Slab allocator for SceneNodes owned by a SceneTree.
+// Nodes are created with std::allocate_shared, so the node and its shared_ptr control block
+// share one fixed-size slot inside a page. Pages are never moved or freed while the pool is
+// alive, which keeps every SceneNode* stable. Freed slots are recycled through a free list.
+class SceneNodePool {
+public:
+    static constexpr size_t kDefaultNodesPerPage = 1024;
+
+    explicit SceneNodePool(size_t nodesPerPage = kDefaultNodesPerPage);
+    ~SceneNodePool();
+
+    SceneNodePool(const SceneNodePool&) = delete;
+    SceneNodePool& operator=(const SceneNodePool&) = delete;
+
+    // Creates a node whose storage lives in the given pool.
+    static std::shared_ptr<SceneNode> makeNode(const std::shared_ptr<SceneNodePool>& pool, ObjectId id,
+                                               const std::string& name, ObjectStatus status = ObjectStatus::Active);
+    static std::shared_ptr<SceneNode> makeNode(const std::shared_ptr<SceneNodePool>& pool, ObjectId id,
+                                               StringAtom name, ObjectStatus status = ObjectStatus::Active);
+
+    // Pre-allocates pages so that at least 'count' more nodes fit without growing.
+    void reserve(size_t count);
+
+    void* allocate(size_t bytes, size_t alignment);
+    void deallocate(void* ptr, size_t bytes, size_t alignment);
+
+    // While bulk release is active, freed slots are set aside instead of being reused.
+    // Ending bulk release with no live nodes left frees every page in one sweep; otherwise the
+    // set-aside slots join the free list and the pages of the surviving nodes are kept.
+    void beginBulkRelease();
+    void endBulkRelease();
+
+    size_t liveCount() const;
+    size_t pageCount() const;
+    size_t capacity() const;
+
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    struct PageDeleter {
+        void operator()(std::byte* page) const;
+    };
+
+    bool ownsSize(size_t bytes, size_t alignment) const;
+    size_t bumpSlots() const;
+    void addPage();
+
+    mutable std::mutex m_mutex;
+    size_t m_nodes_per_page;
+    size_t m_slot_size = 0; // Fixed by the first allocation (node + control block)
+    std::vector<std::unique_ptr<std::byte[], PageDeleter>> m_pages;
+    FreeSlot* m_free_list = nullptr;
+    FreeSlot* m_bulk_freed = nullptr; // Slots released during bulk release
+    std::byte* m_bump = nullptr;
+    std::byte* m_bump_end = nullptr;
+    size_t m_reserved_nodes = 0;
+    size_t m_live = 0;
+    bool m_bulk_release = false;
+};
+
+// Standard allocator adapter used with std::allocate_shared.
+// It keeps the pool alive for as long as any node allocated from it exists.
+template <typename T>
+class SceneNodePoolAllocator {
+public:
+    using value_type = T;
+
+    explicit SceneNodePoolAllocator(std::shared_ptr<SceneNodePool> pool) : m_pool(std::move(pool)) {}
+
+    template <typename U>
+    SceneNodePoolAllocator(const SceneNodePoolAllocator<U>& other) : m_pool(other.pool()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(m_pool->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        m_pool->deallocate(ptr, n * sizeof(T), alignof(T));
+    }
+
+    const std::shared_ptr<SceneNodePool>& pool() const { return m_pool; }
+
+    template <typename U>
+    bool operator==(const SceneNodePoolAllocator<U>& other) const { return m_pool == other.pool(); }
+    template <typename U>
+    bool operator!=(const SceneNodePoolAllocator<U>& other) const { return m_pool != other.pool(); }
+
+private:
+    std::shared_ptr<SceneNodePool> m_pool;
+};
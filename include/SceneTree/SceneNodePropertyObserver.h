@@ -1,13 +1,12 @@
 #pragma once
 #include "SceneTree/SceneNode.h"
-#include <any>
 
 class SceneTree;
 
 class SceneNodePropertyObserver : public INodeObserver {
 public:
     explicit SceneNodePropertyObserver(SceneTree* tree) : m_tree(tree) {}
-    void onNodePropertyChanged(SceneNode* node, NodeProperty prop, const std::any& oldVal, const std::any& newVal) override;
+    void onNodePropertyChanged(SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal) override;
 private:
     SceneTree* m_tree;
 };
\ No newline at end of file
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+class SceneNode;
+
+// How shared subtrees of a DAG are handled.
+// AllPaths yields a node once per path that reaches it (the classic recursive behavior).
+// VisitOnce yields every reachable node exactly once, at its first occurrence.
+enum class VisitMode {
+    AllPaths,
+    VisitOnce
+};
+
+// Returned by a visitor callback to steer the traversal
+enum class VisitResult {
+    Continue,     // Keep going
+    SkipChildren, // Do not descend into the current node (ignored by post-order)
+    Stop          // End the traversal
+};
+
+// Common state for the traversal iterators. All traversals use an explicit stack or queue,
+// so arbitrarily deep hierarchies do not grow the call stack.
+class SceneTraversalBase {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = SceneNode*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = SceneNode* const*;
+    using reference = SceneNode* const&;
+
+    // Path depth of the current node relative to the traversal root (root is 0)
+    size_t depth() const { return m_depth; }
+
+protected:
+    explicit SceneTraversalBase(VisitMode mode) : m_mode(mode) {}
+
+    // Returns false if the node was already visited in VisitOnce mode.
+    // Only nodes with several parents can be reached twice, so others skip the set.
+    bool markVisited(const SceneNode* node);
+
+    SceneNode* m_current = nullptr;
+    size_t m_depth = 0;
+    VisitMode m_mode;
+    std::unordered_set<const SceneNode*> m_visited;
+};
+
+// Depth-first pre-order: a node is yielded before its children, children in insertion order
+class PreOrderIterator : public SceneTraversalBase {
+public:
+    PreOrderIterator() : SceneTraversalBase(VisitMode::AllPaths) {} // End iterator
+    PreOrderIterator(SceneNode* root, VisitMode mode);
+
+    SceneNode* operator*() const { return m_current; }
+    PreOrderIterator& operator++();
+    bool operator==(const PreOrderIterator& other) const { return m_current == other.m_current; }
+    bool operator!=(const PreOrderIterator& other) const { return m_current != other.m_current; }
+
+    // Do not descend into the current node's children on the next increment
+    void skipChildren() { m_skip_children = true; }
+
+private:
+    struct Frame {
+        SceneNode* node;
+        size_t depth;
+    };
+    std::vector<Frame> m_stack;
+    bool m_skip_children = false;
+};
+
+// Depth-first post-order: a node is yielded after all of its children
+class PostOrderIterator : public SceneTraversalBase {
+public:
+    PostOrderIterator() : SceneTraversalBase(VisitMode::AllPaths) {} // End iterator
+    PostOrderIterator(SceneNode* root, VisitMode mode);
+
+    SceneNode* operator*() const { return m_current; }
+    PostOrderIterator& operator++();
+    bool operator==(const PostOrderIterator& other) const { return m_current == other.m_current; }
+    bool operator!=(const PostOrderIterator& other) const { return m_current != other.m_current; }
+
+    // Children are already visited in post-order; provided so visitors can treat all orders alike
+    void skipChildren() {}
+
+private:
+    struct Frame {
+        SceneNode* node;
+        size_t next_child;
+    };
+    void descend();
+
+    std::vector<Frame> m_stack;
+};
+
+// Breadth-first: level by level, children in insertion order
+class BreadthFirstIterator : public SceneTraversalBase {
+public:
+    BreadthFirstIterator() : SceneTraversalBase(VisitMode::AllPaths) {} // End iterator
+    BreadthFirstIterator(SceneNode* root, VisitMode mode);
+
+    SceneNode* operator*() const { return m_current; }
+    BreadthFirstIterator& operator++();
+    bool operator==(const BreadthFirstIterator& other) const { return m_current == other.m_current; }
+    bool operator!=(const BreadthFirstIterator& other) const { return m_current != other.m_current; }
+
+    void skipChildren() { m_skip_children = true; }
+
+private:
+    struct Frame {
+        SceneNode* node;
+        size_t depth;
+    };
+    std::deque<Frame> m_queue;
+    bool m_skip_children = false;
+};
+
+// A begin/end pair usable in range-for. Iterators are single-pass.
+template <typename Iterator>
+class TraversalRange {
+public:
+    TraversalRange(SceneNode* root, VisitMode mode) : m_root(root), m_mode(mode) {}
+
+    Iterator begin() const { return m_root ? Iterator(m_root, m_mode) : Iterator(); }
+    Iterator end() const { return Iterator(); }
+
+private:
+    SceneNode* m_root;
+    VisitMode m_mode;
+};
+
+using PreOrderRange = TraversalRange<PreOrderIterator>;
+using PostOrderRange = TraversalRange<PostOrderIterator>;
+using BreadthFirstRange = TraversalRange<BreadthFirstIterator>;
+
+// Runs 'visitor' over a traversal range. The visitor is called as visitor(SceneNode&, size_t depth)
+// and may return void or a VisitResult. Returns false if the visitor stopped the traversal.
+template <typename Iterator, typename Visitor>
+bool visitNodes(const TraversalRange<Iterator>& range, Visitor&& visitor) {
+    for (auto it = range.begin(), end = range.end(); it != end; ++it) {
+        using Result = std::invoke_result_t<Visitor&, SceneNode&, size_t>;
+        if constexpr (std::is_void_v<Result>) {
+            visitor(**it, it.depth());
+        } else {
+            VisitResult result = visitor(**it, it.depth());
+            if (result == VisitResult::Stop) {
+                return false;
+            }
+            if (result == VisitResult::SkipChildren) {
+                it.skipChildren();
+            }
+        }
+    }
+    return true;
+}
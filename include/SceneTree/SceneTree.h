@@ -4,31 +4,123 @@
 #include <unordered_map>
 #include "SceneTree/SceneNode.h"
 #include "SceneTree/Scene.h"
-#include <any>
+#include "SceneTree/SceneNodePool.h"
+#include "SceneTree/TagMask.h"
+#include "SceneTree/PropertyListeners.h"
+#include "SceneTree/ChangeJournal.h"
+#include "SceneTree/LiveQuery.h"
+#include "SceneTree/NodeBucket.h"
+#include "SceneTree/FlatHashMap.h"
+#include "SceneTree/Span.h"
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <mutex>
+
+namespace task_engine {
+    class TaskExecutor;
+}
 
 class SceneTree {
 private:
 public:
-    explicit SceneTree(std::shared_ptr<SceneNode> root);
+    explicit SceneTree(std::shared_ptr<SceneNode> root, std::shared_ptr<SceneNodePool> pool = nullptr);
     virtual ~SceneTree();
 
     static std::unique_ptr<SceneTree> createFromScene(const Scene& scene);
 
+    // Allocates a node from this tree's node pool (created on first use).
+    // The node is not linked into the hierarchy; use addChild/attach for that.
+    std::shared_ptr<SceneNode> createNode(ObjectId id, const std::string& name, ObjectStatus status = ObjectStatus::Active);
+    const std::shared_ptr<SceneNodePool>& getNodePool() const;
+
     SceneNode* findNode(ObjectId id);
+    // Batch form of findNode: writes the node for ids[i] (or nullptr) to out[i]. The lookup of
+    // each id is prefetched a few ids ahead, so resolving thousands of ids overlaps their cache
+    // misses instead of paying them one by one. Throws if 'out' is shorter than 'ids'.
+    void findNodes(Span<const ObjectId> ids, Span<SceneNode*> out) const;
     
-    // Find nodes by name (delegates to SceneNode's recursive search)
+    // Find nodes by name (delegates to SceneNode's recursive search).
+    // Every lookup accepts either a string or a pre-interned StringAtom; string keys that were
+    // never interned cannot match any node and return immediately.
     std::shared_ptr<SceneNode> findNodeByName(const std::string& name) const;
+    std::shared_ptr<SceneNode> findNodeByName(StringAtom name) const;
     std::shared_ptr<SceneNode> findFirstChildNodeByName(const std::string& name) const;
+    std::shared_ptr<SceneNode> findFirstChildNodeByName(StringAtom name) const;
     std::vector<std::shared_ptr<SceneNode>> findAllNodesByName(const std::string& name) const;
+    std::vector<std::shared_ptr<SceneNode>> findAllNodesByName(StringAtom name) const;
 
     // Tag-based lookup for script systems and fast retrieval
     std::shared_ptr<SceneNode> findFirstNodeByTag(const std::string& tag) const;
+    std::shared_ptr<SceneNode> findFirstNodeByTag(StringAtom tag) const;
     std::vector<std::shared_ptr<SceneNode>> findAllNodesByTag(const std::string& tag) const;
+    std::vector<std::shared_ptr<SceneNode>> findAllNodesByTag(StringAtom tag) const;
+
+    // Multi-tag queries over the dense per-node tag masks, e.g.
+    //   auto q = tree.makeTagQuery({"Enemy", "Alive"}, {"Stunned"});
+    //   tree.findNodesByTags(q, buffer);
+    // The scan is vectorized and writes raw pointers, so a reused buffer makes it allocation-free.
+    TagQuery makeTagQuery(const std::vector<std::string>& include, const std::vector<std::string>& exclude = {}) const;
+    TagQuery makeTagQuery(const std::vector<StringAtom>& include, const std::vector<StringAtom>& exclude = {}) const;
+    TagQuery makeTagQuery(std::initializer_list<const char*> include, std::initializer_list<const char*> exclude = {}) const;
+    void findNodesByTags(const TagQuery& query, std::vector<SceneNode*>& out) const;
+    std::vector<SceneNode*> findNodesByTags(const TagQuery& query) const;
+    TagMask getTagMask(const SceneNode* node) const;
+    const TagRegistry& getTagRegistry() const;
+
+    // True if 'node' is reachable from 'ancestor' (a node counts as its own ancestor).
+    // Backed by a pre/post-order interval labeling that is rebuilt lazily after structural
+    // changes, so repeated checks are O(1) for tree edges and O(log k) for DAG nodes.
+    // Concurrent calls are safe (the rebuild is serialized) as long as nothing modifies the
+    // tree at the same time.
+    bool isAncestorOf(const SceneNode* ancestor, const SceneNode* node) const;
+
+    // Live queries replace per-frame "find by tag, then filter" loops, e.g.
+    //   auto enemies = tree.createLiveQuery({{StringAtom::intern("Enemy")}, {}, statusBit(ObjectStatus::Active)});
+    //   for (SceneNode* enemy : enemies->nodes()) ...
+    // The tree keeps the result set current from the TagAdded/TagRemoved/Status/Hierarchy events
+    // it delivers and from nodes entering or leaving it; only the touched nodes are re-evaluated
+    // (scoped queries also re-check the subtree below a changed edge). A query lives as long as
+    // the returned pointer is held.
+    std::shared_ptr<LiveQuery> createLiveQuery(LiveQuerySpec spec);
+
+    // Hierarchical state. A node is effectively active if its status is Active and every parent
+    // in this tree is effectively active; effectively visible if its own visibility flag is set,
+    // its status is not Hidden and every parent is effectively visible. Both are cached per node
+    // and pick up a status or visibility change once it is processed (see processEvents). Such
+    // changes and hierarchy changes mark the node; the next query propagates from the marked
+    // nodes in topological order and stops wherever a cached value does not change, so untouched
+    // subtrees are not revisited.
+    bool isEffectivelyActive(const SceneNode* node) const;
+    bool isEffectivelyVisible(const SceneNode* node) const;
+    // Dense scans over the cached flags; a reused buffer makes them allocation-free
+    void findEffectivelyVisibleNodes(std::vector<SceneNode*>& out) const;
+    void findEffectivelyActiveNodes(std::vector<SceneNode*>& out) const;
 
     // Overloads to start finding from a specific node
     std::shared_ptr<SceneNode> findNodeByName(SceneNode* startNode, const std::string& name) const;
+    std::shared_ptr<SceneNode> findNodeByName(SceneNode* startNode, StringAtom name) const;
     std::vector<std::shared_ptr<SceneNode>> findAllNodesByName(SceneNode* startNode, const std::string& name) const;
+    std::vector<std::shared_ptr<SceneNode>> findAllNodesByName(SceneNode* startNode, StringAtom name) const;
+
+    // Non-owning variants for hot paths: no shared_ptr copies (no atomic refcounting) and no
+    // allocation once 'out' has grown. The spans point straight into the index buckets and,
+    // like the buffers, are only valid until the next name/tag index change (a processed event,
+    // attach, detach or edit commit). The buffer overloads clear 'out' first.
+    NodeSpan nodesByName(const std::string& name) const;
+    NodeSpan nodesByName(StringAtom name) const;
+    NodeSpan nodesByTag(const std::string& tag) const;
+    NodeSpan nodesByTag(StringAtom tag) const;
+    void findAllNodesByName(const std::string& name, std::vector<SceneNode*>& out) const;
+    void findAllNodesByName(StringAtom name, std::vector<SceneNode*>& out) const;
+    void findAllNodesByTag(const std::string& tag, std::vector<SceneNode*>& out) const;
+    void findAllNodesByTag(StringAtom tag, std::vector<SceneNode*>& out) const;
+    void findAllNodesByName(SceneNode* startNode, const std::string& name, std::vector<SceneNode*>& out) const;
+    void findAllNodesByName(SceneNode* startNode, StringAtom name, std::vector<SceneNode*>& out) const;
+    // Calls fn(SceneNode*) for every node named 'name' in the subtree of 'startNode' (itself
+    // included). 'fn' must not rename nodes or change the hierarchy.
+    template <typename Fn>
+    void forEachNodeByName(SceneNode* startNode, StringAtom name, Fn&& fn) const;
 
     // Attaches another tree to a specific node in this tree
     bool attach(SceneNode* parentNode, std::unique_ptr<SceneTree> childTree);
@@ -39,41 +131,284 @@ public:
     void setBatchingEnabled(bool enabled);
     void processEvents();
 
+    // Budgeted processing for spreading a burst of changes (e.g. 100k status changes) over
+    // several frames. Handles pending items (one per dirty node or queued event) until either
+    // limit is reached; a zero limit means unlimited. Dirty nodes and queued events are taken
+    // alternately, so neither kind starves the other. The rest stays queued in order and the
+    // next call resumes with it. Returns the number of items handled.
+    struct EventBudget {
+        size_t maxEvents = 0;
+        std::chrono::microseconds maxTime{0};
+    };
+    size_t processEvents(const EventBudget& budget);
+    // Items still waiting for processEvents()
+    size_t pendingEventCount() const;
+
+    // Transactional bulk edit for procedural construction, e.g.
+    //   {
+    //       auto edit = tree.beginEdit();
+    //       for (...) tree.attach(parent, makeEnemy(...));
+    //   } // Commits here
+    // While a scope is open, attach() only links the subtree, nodes cut off by removeChild()
+    // stay indexed, and name, status, tag and hierarchy events are recorded instead of applied.
+    // commit() then indexes the new subtrees in one pass, applies the recorded changes with one
+    // update per affected name/tag bucket and delivers one notification per net change (a tag
+    // added and removed again, or a name changed back, is not reported at all).
+    // Lookups made inside the scope see the tree as it was at beginEdit(). detach() brings the
+    // indexes up to date before it runs; the notifications still wait for commit().
+    // Scopes nest; only the outermost one commits. The tree must outlive its scopes.
+    class EditScope {
+    public:
+        EditScope(EditScope&& other) noexcept : m_tree(other.m_tree) { other.m_tree = nullptr; }
+        EditScope(const EditScope&) = delete;
+        EditScope& operator=(const EditScope&) = delete;
+        EditScope& operator=(EditScope&&) = delete;
+        ~EditScope() { commit(); }
+
+        // Ends the scope early; does nothing if it was already committed
+        void commit();
+
+    private:
+        friend class SceneTree;
+        explicit EditScope(SceneTree* tree) : m_tree(tree) {}
+        SceneTree* m_tree;
+    };
+    [[nodiscard]] EditScope beginEdit();
+    bool isEditing() const;
+
     // Standard update method to be called once per frame by the SceneManager or GameLoop
     void update(double deltaTime);
 
-    // Centralized property listener registration
-    using PropertyListener = std::function<void(SceneNode*, NodeProperty, const std::any&, const std::any&)>;
-    void addPropertyListener(NodeProperty prop, PropertyListener listener);
-    void addNodePropertyListener(ObjectId id, NodeProperty prop, PropertyListener listener);
+    // Centralized property listener registration (see PropertyListeners.h).
+    // add*Listener registers until removePropertyListener() is called; subscribe() returns an
+    // RAII token that removes the listener when it goes out of scope. Node-specific listeners are
+    // dropped automatically when their node leaves the tree.
+    using PropertyListener = ::PropertyListener;
+    ListenerHandle addPropertyListener(NodeProperty prop, PropertyListener listener);
+    ListenerHandle addNodePropertyListener(ObjectId id, NodeProperty prop, PropertyListener listener);
+    bool removePropertyListener(ListenerHandle handle);
+    [[nodiscard]] PropertySubscription subscribe(NodeProperty prop, PropertyListener listener);
+    [[nodiscard]] PropertySubscription subscribe(ObjectId id, NodeProperty prop, PropertyListener listener);
+
+    // Typed registration, e.g.
+    //   tree.addPropertyListener<NodeProperty::Status>([](SceneNode* node, ObjectStatus oldStatus, ObjectStatus newStatus) { ... });
+    // The values are unpacked per PropertyTraits<P>; a side that carries no value is passed empty.
+    template <NodeProperty P>
+    using TypedPropertyListener = std::function<void(SceneNode*, typename PropertyTraits<P>::Value, typename PropertyTraits<P>::Value)>;
+    template <NodeProperty P>
+    ListenerHandle addPropertyListener(TypedPropertyListener<P> listener) {
+        return addPropertyListener(P, unpackListener<P>(std::move(listener)));
+    }
+    template <NodeProperty P>
+    ListenerHandle addNodePropertyListener(ObjectId id, TypedPropertyListener<P> listener) {
+        return addNodePropertyListener(id, P, unpackListener<P>(std::move(listener)));
+    }
+    template <NodeProperty P>
+    [[nodiscard]] PropertySubscription subscribe(TypedPropertyListener<P> listener) {
+        return subscribe(P, unpackListener<P>(std::move(listener)));
+    }
+    template <NodeProperty P>
+    [[nodiscard]] PropertySubscription subscribe(ObjectId id, TypedPropertyListener<P> listener) {
+        return subscribe(id, P, unpackListener<P>(std::move(listener)));
+    }
+
+    // Optional change journal for change-data-capture (editor mirrors, replication, saving).
+    // Once enabled, every change delivered to listeners is also recorded, in delivery order,
+    // together with attach/detach operations. Consumers keep the last sequence number they saw
+    // and tail the journal with readSince(), from any thread. A capacity of 0 disables it.
+    void enableChangeJournal(size_t capacity);
+    std::shared_ptr<const ChangeJournal> getChangeJournal() const;
 
     std::shared_ptr<SceneNode> getRoot() const;
 
     void print() const;
 
+    // Non-recursive traversals from the root (see SceneTraversal.h). Shared nodes are
+    // yielded once by default; use visitNodes() for prune/stop control.
+    PreOrderRange preOrder(VisitMode mode = VisitMode::VisitOnce) const;
+    PostOrderRange postOrder(VisitMode mode = VisitMode::VisitOnce) const;
+    BreadthFirstRange breadthFirst(VisitMode mode = VisitMode::VisitOnce) const;
+
+    // Contiguous, cached linearization of the hierarchy for per-frame sweeps. Every node
+    // reachable from the root appears once, after all of its parents (pre-order for a pure tree).
+    // 'parent' indexes the same array: for a node with several parents it is the one that comes
+    // last, and 'depth' is the length of the longest path from the root.
+    // attach() appends new subtrees and detach() cuts removed nodes out in place; other
+    // hierarchy changes make the next call rebuild the array.
+    struct LinearNode {
+        static constexpr uint32_t kNoParent = 0xFFFFFFFFu;
+        SceneNode* node = nullptr;
+        uint32_t parent = kNoParent;
+        uint32_t depth = 0;
+    };
+    const std::vector<LinearNode>& getLinearOrder() const;
+
+    // Parallel passes on a TaskExecutor (e.g. SceneManager::getTaskExecutor()). Every node
+    // reachable from the root is handed to the functor exactly once, shared nodes included, and
+    // both calls return only after all work is done. The calling thread takes part in the work.
+    // The functor may modify the node it is given; property events raised meanwhile are
+    // serialized through the tree, so enable batching to keep listeners off the worker threads.
+    // The hierarchy itself must not change during the pass.
+    static constexpr size_t kDefaultParallelGrain = 1024;
+    using NodeFunction = std::function<void(SceneNode&)>;
+    using NodeVisitor = std::function<VisitResult(SceneNode&, size_t depth)>;
+    // Unordered: splits the dense node array into chunks of 'grainSize' nodes
+    void parallelForEach(task_engine::TaskExecutor& executor, const NodeFunction& fn,
+                         size_t grainSize = kDefaultParallelGrain);
+    // Pre-order within each task: the top levels are visited on the calling thread until there
+    // are enough subtrees to balance across the executor. SkipChildren prunes as in visitNodes();
+    // Stop ends the pass as soon as running tasks notice. Returns false if a visitor stopped it.
+    // An exception thrown by the visitor is rethrown here after the join.
+    bool parallelVisit(task_engine::TaskExecutor& executor, const NodeVisitor& visitor);
+
 private:
+    template <NodeProperty P>
+    static PropertyListener unpackListener(TypedPropertyListener<P> listener) {
+        using Value = typename PropertyTraits<P>::Value;
+        return [listener = std::move(listener)](SceneNode* node, NodeProperty, const PropertyValue& oldVal, const PropertyValue& newVal) {
+            listener(node, oldVal.get<Value>(), newVal.get<Value>());
+        };
+    }
+
+    struct DeferIndexing {};
+    // Sets up an empty index; used by detach() to move entries over
+    SceneTree(std::shared_ptr<SceneNode> root, DeferIndexing);
+
+    // Per-node bookkeeping; 'slot' indexes the dense per-node arrays below
+    struct NodeEntry {
+        SceneNode* node;
+        uint32_t slot;
+    };
+    using NodeLookup = IndexMap<ObjectId, NodeEntry>;
+
+    void releaseNodes();
+    bool containsNode(const SceneNode* node) const;
+    void invalidateHierarchyCaches();
+    void rebuildReachability() const;
+    bool matchesLiveQuery(const LiveQuery& query, uint32_t slot) const;
+    void rebuildLiveQuery(LiveQuery& query) const;
+    void noteLiveQueryChange(SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal);
+    void syncLiveQueries() const;
+    friend class LiveQuery;
+    void markEffectiveDirty(ObjectId id);
+    void updateEffectiveState() const;
+    void findByEffectiveFlag(uint8_t flag, std::vector<SceneNode*>& out) const;
+    bool appendLinearOrder(SceneNode* start, uint32_t parentIndex) const;
+    void compactLinearOrder();
+    void reserveIndexes(size_t nodeCount);
+    uint32_t insertNodeEntry(SceneNode* node);
+    bool eraseNodeEntry(ObjectId id);
     void buildNodeMap(const std::shared_ptr<SceneNode>& node);
-    void removeNodeMap(const std::shared_ptr<SceneNode>& node);
+    void indexNode(SceneNode* node, INodeObserver* previousObserver = nullptr);
+    std::vector<SceneNode*> collectReleased(SceneNode* start);
+    void addToNameBucket(uint32_t slot, StringAtom name);
+    void removeFromNameBucket(uint32_t slot);
+    void addToTagBucket(uint32_t slot, StringAtom tag);
+    void removeFromTagBucket(uint32_t slot, StringAtom tag);
+    void removeFromBuckets(uint32_t slot);
+    void moveBucketEntries(uint32_t from, uint32_t to);
+    void onChildLinked(ObjectId childId);
+    void onChildUnlinked(ObjectId childId);
     void resolveDirtyNode(SceneNode* node);
-    void handlePropertyChange(SceneNode* node, NodeProperty prop, const std::any& oldVal, const std::any& newVal);
+    void handlePropertyChange(SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal);
+    void publishChange(SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal);
+    void endEdit();
+    template <typename Item>
+    static void compactQueue(std::vector<Item>& queue, size_t& head);
+    void flushEdit();
     friend class SceneNodePropertyObserver;
 
     struct PendingEvent {
         std::weak_ptr<SceneNode> node;
         NodeProperty prop;
-        std::any oldVal;
-        std::any newVal;
+        PropertyValue oldVal;
+        PropertyValue newVal;
     };
     std::vector<std::weak_ptr<SceneNode>> m_dirty_nodes;
     std::vector<PendingEvent> m_event_queue;
+    // Consumption cursors into the queues above (see processEvents)
+    size_t m_dirty_head = 0;
+    size_t m_event_head = 0;
+    bool m_events_turn = false; // processEvents alternates between the two queues
+    uint32_t m_processing_depth = 0;
     bool m_batching_enabled = false;
+    // Set for the duration of a parallel pass; observer callbacks then run under the mutex
+    bool m_parallel_pass = false;
+    std::recursive_mutex m_parallel_mutex;
 
 
     std::unique_ptr<INodeObserver> m_node_observer;
+    std::shared_ptr<SceneNodePool> m_node_pool;
     std::shared_ptr<SceneNode> m_root;
-    std::unordered_map<ObjectId, SceneNode*> m_node_lookup;
-    std::unordered_map<std::string, std::vector<SceneNode*>> m_name_lookup;
-    std::unordered_map<std::string, std::vector<SceneNode*>> m_tag_lookup;
-    std::unordered_map<NodeProperty, std::vector<PropertyListener>> m_global_listeners;
-    std::unordered_map<NodeProperty, std::unordered_map<ObjectId, std::vector<PropertyListener>>> m_node_listeners;
+    NodeLookup m_node_lookup;
+    std::vector<SceneNode*> m_slot_nodes;
+    std::vector<TagMask> m_slot_tags;
+    // Number of parent edges into each node from nodes this tree indexes. A node leaves the
+    // tree when its count drops to zero, which keeps attach/detach decisions local.
+    std::vector<uint32_t> m_slot_refs;
+    bool m_detaching = false;
+
+    // Bulk edit state (see beginEdit)
+    uint32_t m_edit_depth = 0;
+    std::vector<std::shared_ptr<SceneNode>> m_edit_roots;         // Subtrees attached in the edit
+    std::unordered_map<ObjectId, SceneNode*> m_edit_pending;      // Their nodes, not indexed yet
+    std::vector<std::shared_ptr<SceneNode>> m_edit_released;      // Last in-tree parent edge was cut
+    std::vector<PendingEvent> m_edit_notices;                     // Coalesced, awaiting commit
+    TagRegistry m_tag_registry;
+
+    // Reachability labeling (see rebuildReachability), indexed by slot
+    static constexpr uint32_t kNoSlot = 0xFFFFFFFFu;
+    using Interval = std::pair<uint32_t, uint32_t>;
+    mutable std::vector<uint32_t> m_slot_pre;
+    mutable std::vector<uint32_t> m_slot_post;
+    mutable std::unordered_map<uint32_t, std::vector<Interval>> m_extra_intervals;
+    mutable std::atomic<bool> m_reach_dirty{true};
+    mutable std::mutex m_reach_mutex; // Serializes the lazy rebuild
+
+    // Linear order (see getLinearOrder); m_linear_slots is parallel to it and m_slot_linear maps
+    // back, indexed by slot (kNoSlot for nodes not placed yet)
+    mutable std::vector<LinearNode> m_linear_order;
+    mutable std::vector<uint32_t> m_linear_slots;
+    mutable std::vector<uint32_t> m_slot_linear;
+    mutable bool m_linear_dirty = true;
+
+    // Effective state cache (see isEffectivelyVisible), indexed by slot. Pending nodes are kept
+    // by id because slots move when nodes leave the tree.
+    static constexpr uint8_t kEffectiveActive = 1u << 0;
+    static constexpr uint8_t kEffectiveVisible = 1u << 1;
+    static constexpr uint8_t kEffectiveUnknown = 1u << 2; // Not computed yet
+    static constexpr uint8_t kEffectiveQueued = 1u << 3;  // In the pending set or the worklist
+    mutable std::vector<uint8_t> m_slot_effective;
+    mutable std::vector<ObjectId> m_effective_pending;
+
+    // Live queries (see createLiveQuery). Changes are queued by node id and applied when a query
+    // is read; past the node count, a full rescan is cheaper than the queue.
+    mutable std::vector<std::weak_ptr<LiveQuery>> m_live_queries;
+    mutable std::vector<ObjectId> m_query_pending;        // Re-evaluate for every query
+    mutable std::vector<ObjectId> m_query_pending_scopes; // Re-evaluate the subtree for scoped queries
+    mutable bool m_query_rescan = false;
+    IndexMap<StringAtom, NodeBucket> m_name_lookup;
+    IndexMap<StringAtom, NodeBucket> m_tag_lookup;
+    // Back-indices into the buckets above, indexed by slot: where each node's entries sit, so
+    // removal does not search. The bucket key is kept too, since a node that was renamed or
+    // untagged but not processed yet still sits in its old bucket.
+    struct BucketRef {
+        StringAtom key;
+        uint32_t position = NodeBucket::kNone;
+    };
+    std::vector<BucketRef> m_slot_name;
+    std::vector<std::vector<BucketRef>> m_slot_tag_refs; // Few tags per node: scanned linearly
+    std::shared_ptr<ChangeJournal> m_journal;
+    // Shared with the PropertySubscriptions handed out, which may outlive the tree
+    std::shared_ptr<PropertyListenerTable> m_listeners = std::make_shared<PropertyListenerTable>();
 };
+
+template <typename Fn>
+void SceneTree::forEachNodeByName(SceneNode* startNode, StringAtom name, Fn&& fn) const {
+    if (!startNode || !name.isValid() || !containsNode(startNode)) return;
+    if (startNode->getNameAtom() == name) fn(startNode);
+    for (SceneNode* node : nodesByName(name)) {
+        if (node != startNode && isAncestorOf(startNode, node)) fn(node);
+    }
+}
+
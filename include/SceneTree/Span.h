@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+class SceneNode;
+
+// Non-owning view of a contiguous array (C++17 stand-in for std::span). Valid until the
+// array it points into is modified; see the functions returning one for what invalidates it.
+template <typename T>
+class Span {
+public:
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T*;
+
+    Span() = default;
+    Span(T* data, size_t size) : m_data(data), m_size(size) {}
+    template <typename U, typename Alloc>
+    Span(const std::vector<U, Alloc>& vec) : m_data(vec.data()), m_size(vec.size()) {}
+    template <typename U, typename Alloc>
+    Span(std::vector<U, Alloc>& vec) : m_data(vec.data()), m_size(vec.size()) {}
+
+    T* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    T& operator[](size_t i) const { return m_data[i]; }
+    T* begin() const { return m_data; }
+    T* end() const { return m_data + m_size; }
+
+private:
+    T* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+// Read-only list of nodes, e.g. the members of a LiveQuery
+using NodeSpan = Span<SceneNode* const>;
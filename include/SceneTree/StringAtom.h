@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+// A 32-bit handle to a string interned in the process-wide StringAtomTable.
+// Two atoms are equal exactly when their strings are equal, so names and tags can be
+// compared and hashed as integers. The default atom refers to the empty string.
+class StringAtom {
+public:
+    StringAtom() = default;
+    explicit StringAtom(uint32_t index) : m_index(index) {}
+
+    // Interns the string if needed
+    static StringAtom intern(std::string_view str);
+    // Looks up an already interned string without inserting it. Returns an invalid atom if
+    // the string was never interned, which lets lookups for unknown keys fail fast.
+    static StringAtom find(std::string_view str);
+    static StringAtom invalid() { return StringAtom(kInvalidIndex); }
+
+    const std::string& str() const;
+    uint32_t raw() const { return m_index; }
+    bool isValid() const { return m_index != kInvalidIndex; }
+    bool empty() const { return m_index == 0; }
+
+    bool operator==(const StringAtom& other) const { return m_index == other.m_index; }
+    bool operator!=(const StringAtom& other) const { return m_index != other.m_index; }
+    bool operator<(const StringAtom& other) const { return m_index < other.m_index; }
+
+private:
+    static constexpr uint32_t kInvalidIndex = 0xFFFFFFFFu;
+    uint32_t m_index = 0;
+};
+
+namespace std {
+    template <> struct hash<StringAtom> {
+        size_t operator()(const StringAtom& atom) const {
+            return hash<uint32_t>{}(atom.raw());
+        }
+    };
+}
+
+inline std::ostream& operator<<(std::ostream& os, const StringAtom& atom) {
+    return os << atom.str();
+}
+
+// Process-wide string table backing StringAtom.
+// Interning takes an exclusive lock only when a new string is added. Resolving an atom back
+// to its string is lock-free: strings live in fixed-size chunks that are never moved or freed.
+class StringAtomTable {
+public:
+    static StringAtomTable& instance();
+
+    StringAtom intern(std::string_view str);
+    StringAtom find(std::string_view str) const;
+    const std::string& str(StringAtom atom) const;
+    size_t size() const;
+
+private:
+    StringAtomTable();
+    ~StringAtomTable();
+    StringAtomTable(const StringAtomTable&) = delete;
+    StringAtomTable& operator=(const StringAtomTable&) = delete;
+
+    struct Impl;
+    Impl* m_impl;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "SceneTree/StringAtom.h"
+
+// Fixed-width tag bitmask. One bit per tag registered in a SceneTree's TagRegistry.
+// 16 bytes and 16-byte aligned so that a dense array of masks can be scanned with SIMD.
+struct alignas(16) TagMask {
+    static constexpr uint32_t kBits = 128;
+
+    uint64_t words[2] = {0, 0};
+
+    void set(uint32_t bit) { words[bit >> 6] |= (uint64_t(1) << (bit & 63)); }
+    void reset(uint32_t bit) { words[bit >> 6] &= ~(uint64_t(1) << (bit & 63)); }
+    bool test(uint32_t bit) const { return (words[bit >> 6] >> (bit & 63)) & 1; }
+    bool none() const { return (words[0] | words[1]) == 0; }
+
+    // True if every bit of 'include' is set and no bit of 'exclude' is set
+    bool matches(const TagMask& include, const TagMask& exclude) const {
+        return ((words[0] & include.words[0]) == include.words[0]) &&
+               ((words[1] & include.words[1]) == include.words[1]) &&
+               ((words[0] & exclude.words[0]) | (words[1] & exclude.words[1])) == 0;
+    }
+
+    bool operator==(const TagMask& other) const {
+        return words[0] == other.words[0] && words[1] == other.words[1];
+    }
+    bool operator!=(const TagMask& other) const { return !(*this == other); }
+};
+
+// Per-tree mapping from tag atoms to bit indices. Bits are handed out in the order tags first
+// appear in the tree and are never recycled. Tags beyond TagMask::kBits have no bit; queries
+// that mention them fall back to checking the node's tag list.
+class TagRegistry {
+public:
+    static constexpr uint32_t kNoBit = 0xFFFFFFFFu;
+
+    // Returns the bit for 'tag', assigning a new one if there is room
+    uint32_t registerTag(StringAtom tag);
+    // Returns the bit for 'tag' or kNoBit if the tag has none
+    uint32_t bitFor(StringAtom tag) const;
+    bool isRegistered(StringAtom tag) const;
+    size_t size() const { return m_tags.size(); }
+    StringAtom tagForBit(uint32_t bit) const { return m_tags[bit]; }
+
+private:
+    std::unordered_map<StringAtom, uint32_t> m_bits; // kNoBit for overflow tags
+    std::vector<StringAtom> m_tags;
+};
+
+// Include/exclude query over tag masks, e.g. "Enemy AND Alive AND NOT Stunned".
+// Built by SceneTree::makeTagQuery against that tree's registry.
+struct TagQuery {
+    TagMask include;
+    TagMask exclude;
+    // Tags without a bit (registry overflow); matched against SceneNode::hasTag
+    std::vector<StringAtom> overflowInclude;
+    std::vector<StringAtom> overflowExclude;
+    // An include tag that no node in the tree has ever carried: the query matches nothing
+    bool unsatisfiable = false;
+};
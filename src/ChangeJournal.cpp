@@ -0,0 +1,64 @@
+#include "SceneTree/ChangeJournal.h"
+#include <algorithm>
+
+static_assert(sizeof(ObjectId) <= sizeof(uint32_t), "ChangeJournal packs node ids into 32 bits");
+
+ChangeJournal::ChangeJournal(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    m_slots.reset(new Slot[size]);
+    m_mask = size - 1;
+}
+
+void ChangeJournal::record(ObjectId node, ChangeKind kind, NodeProperty property, const PropertyValue& oldVal,
+                           const PropertyValue& newVal) {
+    const uint64_t sequence = m_next.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[sequence & m_mask];
+
+    uint64_t header = uint64_t(node.raw()) |
+                      (uint64_t(static_cast<uint32_t>(property) & 0xFFu) << 32) |
+                      (uint64_t(static_cast<uint8_t>(kind)) << 40) |
+                      (uint64_t(static_cast<uint8_t>(oldVal.type())) << 48) |
+                      (uint64_t(static_cast<uint8_t>(newVal.type())) << 56);
+    uint64_t values = uint64_t(oldVal.bits()) | (uint64_t(newVal.bits()) << 32);
+
+    // Mark the slot as being written. The payload stores are releases, so a reader that sees
+    // any of the new payload also sees the cleared stamp when it re-checks it.
+    slot.stamp.store(0, std::memory_order_relaxed);
+    slot.header.store(header, std::memory_order_release);
+    slot.values.store(values, std::memory_order_release);
+    slot.stamp.store(sequence, std::memory_order_release);
+    m_next.store(sequence + 1, std::memory_order_release);
+}
+
+bool ChangeJournal::readSince(uint64_t after, std::vector<ChangeRecord>& out, size_t maxRecords) const {
+    const uint64_t next = m_next.load(std::memory_order_acquire);
+    const uint64_t oldest = next > capacity() ? next - capacity() : 1;
+    bool complete = after + 1 >= oldest;
+    uint64_t sequence = std::max(after + 1, oldest);
+
+    for (size_t count = 0; sequence < next && count < maxRecords; ++sequence) {
+        const Slot& slot = m_slots[sequence & m_mask];
+        uint64_t stamp = slot.stamp.load(std::memory_order_acquire);
+        uint64_t header = slot.header.load(std::memory_order_acquire);
+        uint64_t values = slot.values.load(std::memory_order_acquire);
+        if (stamp != sequence || slot.stamp.load(std::memory_order_relaxed) != stamp) {
+            // Overwritten by a newer record while we were catching up
+            complete = false;
+            continue;
+        }
+
+        ChangeRecord record;
+        record.sequence = sequence;
+        record.node = ObjectId(static_cast<uint32_t>(header));
+        record.property = static_cast<NodeProperty>((header >> 32) & 0xFFu);
+        record.kind = static_cast<ChangeKind>((header >> 40) & 0xFFu);
+        record.oldVal = PropertyValue::fromBits(static_cast<PropertyValue::Type>((header >> 48) & 0xFFu),
+                                                static_cast<uint32_t>(values));
+        record.newVal = PropertyValue::fromBits(static_cast<PropertyValue::Type>((header >> 56) & 0xFFu),
+                                                static_cast<uint32_t>(values >> 32));
+        out.push_back(record);
+        ++count;
+    }
+    return complete;
+}
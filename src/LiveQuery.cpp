@@ -0,0 +1,41 @@
+#include "SceneTree/LiveQuery.h"
+#include "SceneTree/SceneTree.h"
+
+NodeSpan LiveQuery::nodes() const {
+    if (!m_tree) return {};
+    m_tree->syncLiveQueries();
+    return m_nodes;
+}
+
+bool LiveQuery::contains(const SceneNode* node) const {
+    if (!m_tree || !node) return false;
+    m_tree->syncLiveQueries();
+    auto it = m_positions.find(node->getId());
+    return it != m_positions.end() && m_nodes[it->second] == node;
+}
+
+void LiveQuery::setMember(SceneNode* node, bool member) {
+    auto it = m_positions.find(node->getId());
+    if (member) {
+        if (it != m_positions.end()) {
+            m_nodes[it->second] = node; // Same id, possibly a replacement node
+        } else {
+            m_positions.emplace(node->getId(), static_cast<uint32_t>(m_nodes.size()));
+            m_nodes.push_back(node);
+        }
+        return;
+    }
+    if (it == m_positions.end()) return;
+    uint32_t position = it->second;
+    m_positions.erase(it);
+    if (position + 1 != m_nodes.size()) {
+        m_nodes[position] = m_nodes.back();
+        m_positions[m_nodes[position]->getId()] = position;
+    }
+    m_nodes.pop_back();
+}
+
+void LiveQuery::clear() {
+    m_nodes.clear();
+    m_positions.clear();
+}
@@ -0,0 +1,36 @@
+#include "SceneTree/NodeBucket.h"
+
+uint32_t NodeBucket::insert(SceneNode* node, uint32_t owner) {
+    uint32_t position = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back(node);
+    m_links.push_back({owner, m_tail, kNone});
+    if (m_tail != kNone) {
+        m_links[m_tail].next = position;
+    } else {
+        m_head = position;
+    }
+    m_tail = position;
+    return position;
+}
+
+uint32_t NodeBucket::erase(uint32_t position) {
+    // Unlink from the insertion order
+    const Link removed = m_links[position];
+    if (removed.prev != kNone) m_links[removed.prev].next = removed.next; else m_head = removed.next;
+    if (removed.next != kNone) m_links[removed.next].prev = removed.prev; else m_tail = removed.prev;
+
+    // Fill the gap with the last entry and repoint its neighbours
+    uint32_t last = static_cast<uint32_t>(m_nodes.size() - 1);
+    uint32_t movedOwner = kNone;
+    if (position != last) {
+        m_nodes[position] = m_nodes[last];
+        m_links[position] = m_links[last];
+        const Link& moved = m_links[position];
+        if (moved.prev != kNone) m_links[moved.prev].next = position; else m_head = position;
+        if (moved.next != kNone) m_links[moved.next].prev = position; else m_tail = position;
+        movedOwner = moved.owner;
+    }
+    m_nodes.pop_back();
+    m_links.pop_back();
+    return movedOwner;
+}
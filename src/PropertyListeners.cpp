@@ -0,0 +1,201 @@
+#include "SceneTree/PropertyListeners.h"
+#include <algorithm>
+
+namespace {
+// Position of the property's bit, used to index the per-property arrays
+uint8_t propertyIndex(NodeProperty prop) {
+    uint32_t bits = static_cast<uint32_t>(prop);
+    uint8_t index = 0;
+    while (bits > 1) {
+        bits >>= 1;
+        ++index;
+    }
+    return index;
+}
+}
+
+ListenerHandle PropertyListenerTable::add(NodeProperty prop, PropertyListener listener) {
+    return insert(prop, true, ObjectId(), std::move(listener));
+}
+
+ListenerHandle PropertyListenerTable::add(ObjectId id, NodeProperty prop, PropertyListener listener) {
+    return insert(prop, false, id, std::move(listener));
+}
+
+ListenerHandle PropertyListenerTable::insert(NodeProperty prop, bool global, ObjectId id, PropertyListener listener) {
+    if (!listener) return {};
+
+    uint32_t index;
+    if (!m_free_records.empty()) {
+        index = m_free_records.back();
+        m_free_records.pop_back();
+    } else {
+        index = static_cast<uint32_t>(m_records.size());
+        m_records.emplace_back();
+    }
+
+    Record& record = m_records[index];
+    record.listener = std::make_unique<PropertyListener>(std::move(listener));
+    record.property = propertyIndex(prop);
+    record.global = global;
+    record.erasing = false;
+    record.node = id;
+
+    EntryList& entries = global ? m_global[record.property] : m_by_node[record.property][id];
+    record.position = static_cast<uint32_t>(entries.size());
+    entries.push_back({record.listener.get(), index});
+    if (!global) m_node_records[id].push_back(index);
+    updateMasks(record.property);
+    return {index, record.generation};
+}
+
+bool PropertyListenerTable::contains(ListenerHandle handle) const {
+    if (handle.index >= m_records.size()) return false;
+    const Record& record = m_records[handle.index];
+    return record.generation == handle.generation && record.listener && !record.erasing;
+}
+
+bool PropertyListenerTable::remove(ListenerHandle handle) {
+    if (!contains(handle)) return false;
+    Record& record = m_records[handle.index];
+    if (!record.global) {
+        // O(k) in the node's own listener count, which is small
+        auto it = m_node_records.find(record.node);
+        auto& records = it->second;
+        records.erase(std::find(records.begin(), records.end(), handle.index));
+        if (records.empty()) m_node_records.erase(it);
+    }
+    detachRecord(handle.index);
+    return true;
+}
+
+// Erases the record, or blanks its entry if the entry list may be iterated right now
+void PropertyListenerTable::detachRecord(uint32_t recordIndex) {
+    if (m_dispatch_depth > 0) {
+        Record& record = m_records[recordIndex];
+        (*entriesOf(record))[record.position].listener = nullptr;
+        record.erasing = true;
+        m_deferred.push_back(recordIndex);
+    } else {
+        erase(recordIndex);
+    }
+}
+
+void PropertyListenerTable::removeNode(ObjectId id) {
+    auto it = m_node_records.find(id);
+    if (it == m_node_records.end()) return;
+    std::vector<uint32_t> records = std::move(it->second);
+    m_node_records.erase(it);
+    for (uint32_t index : records) {
+        detachRecord(index);
+    }
+}
+
+PropertyListenerTable::EntryList* PropertyListenerTable::entriesOf(const Record& record) {
+    if (record.global) return &m_global[record.property];
+    auto& byNode = m_by_node[record.property];
+    auto it = byNode.find(record.node);
+    return it != byNode.end() ? &it->second : nullptr;
+}
+
+// Swap-removes the record's entry and frees the record
+void PropertyListenerTable::erase(uint32_t recordIndex) {
+    Record& record = m_records[recordIndex];
+    EntryList* entries = entriesOf(record);
+    if (entries) {
+        uint32_t position = record.position;
+        if (position + 1 != entries->size()) {
+            (*entries)[position] = entries->back();
+            m_records[(*entries)[position].record].position = position;
+        }
+        entries->pop_back();
+        if (entries->empty() && !record.global) {
+            m_by_node[record.property].erase(record.node);
+        }
+    }
+    uint8_t property = record.property;
+    record.listener.reset();
+    ++record.generation;
+    m_free_records.push_back(recordIndex);
+    updateMasks(property);
+}
+
+void PropertyListenerTable::updateMasks(uint8_t property) {
+    uint32_t bit = 1u << property;
+    m_global_mask = m_global[property].empty() ? (m_global_mask & ~bit) : (m_global_mask | bit);
+    m_node_mask = m_by_node[property].empty() ? (m_node_mask & ~bit) : (m_node_mask | bit);
+}
+
+void PropertyListenerTable::dispatch(SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal) {
+    const uint32_t bit = static_cast<uint32_t>(prop);
+    if (((m_global_mask | m_node_mask) & bit) == 0) return;
+    const uint8_t property = propertyIndex(prop);
+
+    // Erases deferred removals once the outermost dispatch is over, even if a listener throws
+    struct DispatchScope {
+        PropertyListenerTable& table;
+        explicit DispatchScope(PropertyListenerTable& t) : table(t) { ++table.m_dispatch_depth; }
+        ~DispatchScope() {
+            if (--table.m_dispatch_depth > 0 || table.m_deferred.empty()) return;
+            std::vector<uint32_t> deferred = std::move(table.m_deferred);
+            table.m_deferred.clear();
+            for (uint32_t index : deferred) table.erase(index);
+        }
+    } scope(*this);
+
+    // Global listeners first, then node-specific ones. Entries are re-read by index because a
+    // listener may add listeners (and so reallocate the list) while it runs.
+    if (m_global_mask & bit) {
+        const EntryList& entries = m_global[property];
+        for (size_t i = 0, count = entries.size(); i < count; ++i) {
+            if (PropertyListener* listener = entries[i].listener) (*listener)(node, prop, oldVal, newVal);
+        }
+    }
+    if (m_node_mask & bit) {
+        auto& byNode = m_by_node[property];
+        auto it = byNode.find(node->getId());
+        if (it != byNode.end()) {
+            const EntryList& entries = it->second;
+            for (size_t i = 0, count = entries.size(); i < count; ++i) {
+                if (PropertyListener* listener = entries[i].listener) (*listener)(node, prop, oldVal, newVal);
+            }
+        }
+    }
+}
+
+// --- PropertySubscription ---
+
+PropertySubscription::PropertySubscription(PropertySubscription&& other) noexcept
+    : m_table(std::move(other.m_table)), m_handle(other.m_handle) {
+    other.m_handle = ListenerHandle();
+}
+
+PropertySubscription& PropertySubscription::operator=(PropertySubscription&& other) noexcept {
+    if (this != &other) {
+        reset();
+        m_table = std::move(other.m_table);
+        m_handle = other.m_handle;
+        other.m_handle = ListenerHandle();
+    }
+    return *this;
+}
+
+void PropertySubscription::reset() {
+    if (auto table = m_table.lock()) {
+        table->remove(m_handle);
+    }
+    m_table.reset();
+    m_handle = ListenerHandle();
+}
+
+ListenerHandle PropertySubscription::release() {
+    ListenerHandle handle = m_handle;
+    m_table.reset();
+    m_handle = ListenerHandle();
+    return handle;
+}
+
+bool PropertySubscription::isActive() const {
+    auto table = m_table.lock();
+    return table && table->contains(m_handle);
+}
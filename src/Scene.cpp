@@ -3,6 +3,12 @@
 
 Scene::Scene(std::string name) : m_name(std::move(name)) {}
 
+void Scene::reserve(size_t count) {
+    m_objects.reserve(count);
+    m_insertion_order.reserve(count);
+    m_relationships.reserve(count);
+}
+
 SceneObject* Scene::addObject(ObjectId id, const std::string& name, ObjectStatus status, ObjectId parentId) {
     auto [it, success] = m_objects.try_emplace(id, SceneObject{id, name, status});
     if (success) {
@@ -0,0 +1,200 @@
+#include "SceneTree/SceneBinary.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+static_assert(sizeof(SceneBinary::Header) == 32, "SceneBinary::Header is part of the file format");
+static_assert(sizeof(SceneBinary::Node) == 32, "SceneBinary::Node is part of the file format");
+static_assert(sizeof(SceneBinary::String) == 8, "SceneBinary::String is part of the file format");
+static_assert(std::is_trivially_copyable<SceneBinary::Node>::value, "Records are copied as raw bytes");
+static_assert(sizeof(ObjectId) == sizeof(uint32_t), "Node ids are stored as 32-bit integers");
+
+template <typename T>
+static void appendRecords(std::vector<uint8_t>& out, const std::vector<T>& records) {
+    if (records.empty()) return;
+    const auto* bytes = reinterpret_cast<const uint8_t*>(records.data());
+    out.insert(out.end(), bytes, bytes + records.size() * sizeof(T));
+}
+
+// Records are copied out of the buffer rather than cast in place, since nothing guarantees
+// that a caller-provided buffer is aligned
+template <typename T>
+static T readRecord(const uint8_t* base, size_t index) {
+    T record;
+    std::memcpy(&record, base + index * sizeof(T), sizeof(T));
+    return record;
+}
+
+bool SceneBinary::isBinary(const void* data, size_t size) {
+    return size >= sizeof(kMagic) && std::memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+std::vector<uint8_t> SceneBinary::encode(const SceneTree& tree) {
+    std::vector<uint8_t> out;
+    const auto& root = tree.getRoot();
+    if (!root) return out;
+
+    // 1. Number the reachable nodes in topological order (Kahn's algorithm over the in-subgraph
+    //    parent counts). Children are pushed in reverse, so a pure tree comes out in pre-order.
+    std::unordered_map<const SceneNode*, uint32_t> pending; // Unvisited parents, then the index
+    for (SceneNode* node : root->preOrder()) {
+        pending.try_emplace(node, 0);
+        for (const auto& child : node->getChildren()) ++pending[child.get()];
+    }
+    std::vector<const SceneNode*> order;
+    order.reserve(pending.size());
+    std::vector<const SceneNode*> stack{root.get()};
+    while (!stack.empty()) {
+        const SceneNode* node = stack.back();
+        stack.pop_back();
+        order.push_back(node);
+        const auto& children = node->getChildren();
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            if (--pending[it->get()] == 0) stack.push_back(it->get());
+        }
+    }
+    for (uint32_t i = 0; i < order.size(); ++i) pending[order[i]] = i;
+
+    // 2. Fill the sections. Names and tags share one pool of distinct strings.
+    std::vector<Node> nodes;
+    std::vector<uint32_t> children;
+    std::vector<String> tags;
+    std::vector<char> strings;
+    IndexMap<StringAtom, String> pooled;
+    auto poolString = [&](StringAtom atom) {
+        auto [it, inserted] = pooled.try_emplace(atom);
+        if (inserted) {
+            const std::string& str = atom.str();
+            it->second = String{static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(str.size())};
+            strings.insert(strings.end(), str.begin(), str.end());
+        }
+        return it->second;
+    };
+
+    nodes.reserve(order.size());
+    for (const SceneNode* node : order) {
+        Node record{};
+        record.id = node->getId().raw();
+        record.name = poolString(node->getNameAtom());
+        record.firstChild = static_cast<uint32_t>(children.size());
+        record.childCount = static_cast<uint32_t>(node->getChildren().size());
+        for (const auto& child : node->getChildren()) children.push_back(pending[child.get()]);
+        record.firstTag = static_cast<uint32_t>(tags.size());
+        record.tagCount = static_cast<uint32_t>(node->getTags().size());
+        for (StringAtom tag : node->getTags()) tags.push_back(poolString(tag));
+        record.status = static_cast<uint8_t>(node->getStatus());
+        record.flags = node->isVisible() ? 0 : kHidden;
+        nodes.push_back(record);
+    }
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrderMark;
+    header.nodeCount = static_cast<uint32_t>(nodes.size());
+    header.childCount = static_cast<uint32_t>(children.size());
+    header.tagCount = static_cast<uint32_t>(tags.size());
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+
+    out.reserve(sizeof(Header) + nodes.size() * sizeof(Node) + children.size() * sizeof(uint32_t) +
+                tags.size() * sizeof(String) + strings.size());
+    const auto* headerBytes = reinterpret_cast<const uint8_t*>(&header);
+    out.insert(out.end(), headerBytes, headerBytes + sizeof(Header));
+    appendRecords(out, nodes);
+    appendRecords(out, children);
+    appendRecords(out, tags);
+    out.insert(out.end(), strings.begin(), strings.end());
+    return out;
+}
+
+std::unique_ptr<SceneTree> SceneBinary::decode(const uint8_t* data, size_t size) {
+    auto fail = [](const char* reason) -> std::unique_ptr<SceneTree> {
+        std::cerr << "[SceneIO] Binary Load Error: " << reason << std::endl;
+        return nullptr;
+    };
+
+    if (!data || size < sizeof(Header) || !isBinary(data, size)) return fail("not a binary scene file.");
+    const Header header = readRecord<Header>(data, 0);
+    if (header.byteOrder != kByteOrderMark) return fail("file was written with a different byte order.");
+    if (header.version > kVersion) {
+        std::cerr << "[SceneIO] Binary Load Error: File version (" << header.version
+                  << ") is newer than supported version (" << kVersion << ")." << std::endl;
+        return nullptr;
+    }
+    if (header.nodeCount == 0) return fail("file has no nodes.");
+
+    // Section bounds, in 64-bit so that corrupt counts cannot wrap around
+    const uint64_t nodesAt = sizeof(Header);
+    const uint64_t childrenAt = nodesAt + uint64_t(header.nodeCount) * sizeof(Node);
+    const uint64_t tagsAt = childrenAt + uint64_t(header.childCount) * sizeof(uint32_t);
+    const uint64_t stringsAt = tagsAt + uint64_t(header.tagCount) * sizeof(String);
+    if (stringsAt + header.stringBytes > size) return fail("file is truncated.");
+
+    const uint8_t* nodeTable = data + nodesAt;
+    const uint8_t* childTable = data + childrenAt;
+    const uint8_t* tagTable = data + tagsAt;
+    const char* stringPool = reinterpret_cast<const char*>(data + stringsAt);
+    auto inRange = [](uint64_t first, uint64_t count, uint64_t total) { return first + count <= total; };
+    auto atomOf = [&](const String& str) {
+        return StringAtom::intern(std::string_view(stringPool + str.offset, str.length));
+    };
+
+    // 1. Validate every record before creating anything, so that a corrupt file interns no
+    //    strings and allocates no nodes. Every node but the root needs a parent that lists it.
+    std::vector<bool> referenced(header.nodeCount, false);
+    for (uint32_t i = 0; i < header.nodeCount; ++i) {
+        const Node record = readRecord<Node>(nodeTable, i);
+        if (!inRange(record.name.offset, record.name.length, header.stringBytes) ||
+            !inRange(record.firstChild, record.childCount, header.childCount) ||
+            !inRange(record.firstTag, record.tagCount, header.tagCount)) {
+            return fail("node record points outside its section.");
+        }
+        for (uint32_t t = 0; t < record.tagCount; ++t) {
+            const String tag = readRecord<String>(tagTable, record.firstTag + t);
+            if (!inRange(tag.offset, tag.length, header.stringBytes)) return fail("tag points outside the string pool.");
+        }
+        for (uint32_t c = 0; c < record.childCount; ++c) {
+            uint32_t child = readRecord<uint32_t>(childTable, record.firstChild + c);
+            if (child <= i || child >= header.nodeCount) return fail("child index out of order.");
+            referenced[child] = true;
+        }
+    }
+    if (std::find(referenced.begin() + 1, referenced.end(), false) != referenced.end()) {
+        return fail("node record is not reachable from the root.");
+    }
+
+    // 2. Create every node. Strings are interned straight from the pool.
+    auto pool = std::make_shared<SceneNodePool>();
+    pool->reserve(header.nodeCount);
+    std::vector<std::shared_ptr<SceneNode>> nodes(header.nodeCount);
+    for (uint32_t i = 0; i < header.nodeCount; ++i) {
+        const Node record = readRecord<Node>(nodeTable, i);
+        ObjectStatus status = record.status <= static_cast<uint8_t>(ObjectStatus::Broken)
+                                  ? static_cast<ObjectStatus>(record.status)
+                                  : ObjectStatus::Active;
+        auto node = SceneNodePool::makeNode(pool, ObjectId(record.id), atomOf(record.name), status);
+        for (uint32_t t = 0; t < record.tagCount; ++t) {
+            node->addTag(atomOf(readRecord<String>(tagTable, record.firstTag + t)));
+        }
+        if (record.flags & kHidden) node->setVisible(false);
+        nodes[i] = std::move(node);
+    }
+
+    // 3. Link children in file order. A child's index is past its parent's, so the child has no
+    //    children of its own yet and every link is O(1).
+    std::vector<std::shared_ptr<SceneNode>> children;
+    for (uint32_t i = 0; i < header.nodeCount; ++i) {
+        const Node record = readRecord<Node>(nodeTable, i);
+        if (record.childCount == 0) continue;
+        children.clear();
+        for (uint32_t c = 0; c < record.childCount; ++c) {
+            children.push_back(nodes[readRecord<uint32_t>(childTable, record.firstChild + c)]);
+        }
+        nodes[i]->addChildren(children);
+    }
+
+    return std::make_unique<SceneTree>(nodes.front(), pool);
+}
@@ -1,157 +1,524 @@
 #include "SceneTree/SceneIO.h"
 #include "SceneTree/SceneObject.h"
+#include "SceneTree/SceneBinary.h"
+#include "SceneTree/MappedFile.h"
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
 #include <vector>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
 
-static const int CURRENT_FORMAT_VERSION = 1;
+// Version 2 writes a node with several parents once and refers to it by a key afterwards
+static const int CURRENT_FORMAT_VERSION = 2;
 
-// Helper function to serialize a single node recursively
-static void serializeNode(json& j_node, const std::shared_ptr<SceneNode>& node) {
-    if (!node) return;
-
-    j_node["id"] = node->getId().raw();
-    j_node["name"] = node->getName();
-    j_node["status"] = statusToString(node->getStatus());
+// Helper function to serialize a single node's own properties
+static void serializeNodeProperties(json& j_node, const SceneNode& node) {
+    j_node["id"] = node.getId().raw();
+    j_node["name"] = node.getName();
+    j_node["status"] = statusToString(node.getStatus());
+    if (!node.isVisible()) {
+        j_node["visible"] = false; // Omitted for the default
+    }
 
     // --- Tags ---
-    const auto& tags = node->getTags();
+    const auto& tags = node.getTags();
     if (!tags.empty()) {
-        j_node["tags"] = tags;
+        json j_tags = json::array();
+        for (const auto& tag : tags) {
+            j_tags.push_back(tag.str());
+        }
+        j_node["tags"] = j_tags;
     }
 
     // --- Future Extensions ---
+}
 
-    // --- Children (Recursive) ---
-    const auto& children = node->getChildren();
-    if (!children.empty()) {
-        json j_children = json::array();
-        for (const auto& child : children) {
-            json j_child;
-            serializeNode(j_child, child);
-            j_children.push_back(j_child);
+// Serializes a subtree without recursion. The format nests every child inside its parent. A
+// node with several parents is written in full at its first occurrence in pre-order, with a
+// "key" numbering the shared nodes of this document; every later occurrence is a
+// {"ref": key} entry, so the output is linear in the number of nodes. Ids are not unique
+// enough for this: two distinct nodes may share one.
+static void serializeNode(json& j_node, const std::shared_ptr<SceneNode>& node) {
+    if (!node) return;
+
+    // path[d] is the JSON object of the node currently open at depth d. Children are appended
+    // only after the previous sibling's subtree is finished, so the pointers stay valid.
+    std::vector<json*> path;
+    IndexMap<const SceneNode*, uint32_t> keys; // Shared nodes already written in full
+    auto range = node->preOrder(VisitMode::AllPaths);
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        path.resize(it.depth());
+        json* j_current = &j_node;
+        if (!path.empty()) {
+            json& j_children = (*path.back())["children"];
+            j_children.push_back(json::object());
+            j_current = &j_children.back();
+        }
+        const SceneNode& current = **it;
+        // Only nodes with several parents can be reached twice, so others skip the map
+        if (it.depth() > 0 && current.getParents().size() > 1) {
+            auto [entry, inserted] = keys.try_emplace(&current, static_cast<uint32_t>(keys.size() + 1));
+            if (!inserted) {
+                (*j_current)["ref"] = entry->second;
+                it.skipChildren();
+                continue;
+            }
+            (*j_current)["key"] = entry->second;
         }
-        j_node["children"] = j_children;
+        serializeNodeProperties(*j_current, current);
+        path.push_back(j_current);
     }
 }
 
 bool SceneIO::saveSceneTree(const SceneTree& tree, const std::string& filepath) {
+    return saveSceneTree(tree, filepath, SceneFormat::Json);
+}
+
+bool SceneIO::saveSceneTree(const SceneTree& tree, const std::string& filepath, SceneFormat format) {
     auto root = tree.getRoot();
     if (!root) {
         std::cerr << "[SceneIO] Error: SceneTree has no root." << std::endl;
         return false;
     }
 
-    std::ofstream ofs(filepath);
+    std::ofstream ofs(filepath, std::ios::binary);
     if (!ofs.is_open()) {
         std::cerr << "[SceneIO] Error: Could not open file for writing: " << filepath << std::endl;
         return false;
     }
 
+    if (format == SceneFormat::Binary) {
+        std::vector<uint8_t> bytes = SceneBinary::encode(tree);
+        ofs.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(ofs);
+    }
+
     json j;
     j["format_version"] = CURRENT_FORMAT_VERSION;
     
     json j_root;
     serializeNode(j_root, root);
-    j["root"] = j_root;
+    j["root"] = std::move(j_root);
 
-    ofs << j.dump(4);
-    return true;
+    // The binary encoders write straight into the stream
+    switch (format) {
+        case SceneFormat::Json: ofs << j.dump(4); break;
+        case SceneFormat::CompactJson: ofs << j.dump(); break;
+        case SceneFormat::Cbor: json::to_cbor(j, ofs); break;
+        case SceneFormat::MessagePack: json::to_msgpack(j, ofs); break;
+        case SceneFormat::Ubjson: json::to_ubjson(j, ofs); break;
+        case SceneFormat::Bson: json::to_bson(j, ofs); break;
+        case SceneFormat::Binary: break;
+    }
+    return static_cast<bool>(ofs);
 }
 
-// Helper function to deserialize a single node recursively
-static std::shared_ptr<SceneNode> deserializeNode(const json& val, int version) {
-    if (!val.is_object()) return nullptr;
+namespace {
 
-    // --- Core Properties ---
-    if (!val.contains("id") || !val["id"].is_number_unsigned()) {
-        std::cerr << "[SceneIO] Warning: Node missing valid 'id'." << std::endl;
-        return nullptr;
+// Streaming document loader: builds SceneNodes straight from nlohmann's SAX events, so the
+// document is never materialized as a DOM. The events are the same for every encoding. Each
+// open node object keeps its fields and its finished children on a stack until its closing
+// brace, because keys may come in any order (the saver's sorted keys put "children" before
+// "id"). Peak memory is the tree plus one frame per level.
+// The top-level object is either a legacy root node or a versioned wrapper, and only a
+// "format_version" key tells them apart. Once it has been seen, the legacy node keys are
+// skipped. Until then both readings are kept, the warnings of each are held back, and the
+// reading that loses is dropped when the object closes.
+// A {"ref": key} child is the node written earlier in the document with that "key". In
+// pre-order that node's object has closed by then, so the reference links the existing node.
+class SceneSaxLoader : public nlohmann::json_sax<json> {
+public:
+    // 'label' names the encoding in error messages
+    SceneSaxLoader(std::shared_ptr<SceneNodePool> pool, const char* label)
+        : m_pool(std::move(pool)), m_label(label) {}
+
+    // Version of a wrapped document, 0 for the legacy layout
+    int version() const { return m_document.versioned ? m_document.version : 0; }
+
+    // The root node after a successful parse, or nullptr if the document had none
+    std::shared_ptr<SceneNode> takeRoot() {
+        if (!m_done) return nullptr;
+        const Field kept = m_document.versioned ? Field::Root : Field::Children;
+        for (auto& [field, message] : m_deferred) {
+            if (field == kept) std::cerr << "[SceneIO] Warning: " << message << std::endl;
+        }
+        m_deferred.clear();
+        return m_document.versioned ? std::move(m_document.root) : buildNode(m_document);
     }
-    ObjectId id(val["id"].get<unsigned int>());
 
-    std::string name = "Unnamed";
-    if (val.contains("name") && val["name"].is_string()) {
-        name = val["name"].get<std::string>();
+    bool null() override { return scalar(); }
+    bool boolean(bool val) override {
+        if (Frame* node = currentNode(); node && node->field == Field::Visible) node->visible = val;
+        return scalar();
+    }
+    bool number_integer(number_integer_t val) override {
+        if (Frame* node = currentNode()) {
+            // UBJSON and BSON have no unsigned types, so their ids arrive here
+            if (val >= 0) setId(*node, static_cast<number_unsigned_t>(val));
+            if (node->field == Field::FormatVersion) setVersion(*node, val);
+        }
+        return scalar();
+    }
+    bool number_unsigned(number_unsigned_t val) override {
+        if (Frame* node = currentNode()) {
+            setId(*node, val);
+            if (node->field == Field::FormatVersion) setVersion(*node, static_cast<number_integer_t>(val));
+        }
+        return scalar();
+    }
+    bool number_float(number_float_t, const string_t&) override { return scalar(); }
+    bool binary(binary_t&) override { return scalar(); }
+    bool string(string_t& val) override {
+        if (m_skip == 0 && !m_frames.empty()) {
+            Frame& top = m_frames.back();
+            if (top.kind == Kind::Tags) {
+                m_frames[top.owner].tags.push_back(StringAtom::intern(val));
+            } else if (top.kind == Kind::Node && top.field == Field::Name) {
+                top.name = StringAtom::intern(val);
+            } else if (top.kind == Kind::Node && top.field == Field::Status) {
+                top.status = statusFromString(val);
+            }
+        }
+        return scalar();
     }
 
-    ObjectStatus status = ObjectStatus::Active;
-    if (val.contains("status") && val["status"].is_string()) {
-        status = statusFromString(val["status"].get<std::string>());
+    bool key(string_t& key) override {
+        Frame* node = currentNode();
+        if (!node) return true;
+        // Every key resets its field first, so a repeated key behaves like the DOM (last wins)
+        node->field = fieldFor(key, node->isDocument, node->versioned);
+        // The two readings of the document never reference each other's nodes
+        if (node->field == Field::Children || node->field == Field::Root) {
+            if (node->isDocument) m_shared.clear();
+        }
+        switch (node->field) {
+            case Field::Id: node->id.reset(); break;
+            case Field::Key: node->sharedKey.reset(); break;
+            case Field::Ref: node->ref.reset(); break;
+            case Field::Name: node->name = unnamed(); break;
+            case Field::Status: node->status = ObjectStatus::Active; break;
+            case Field::Visible: node->visible = true; break;
+            case Field::Tags: node->tags.clear(); break;
+            case Field::Children: node->children.clear(); break;
+            case Field::FormatVersion: node->versioned = false; break;
+            case Field::Root: node->root.reset(); break;
+            case Field::Other: break;
+        }
+        return true;
     }
 
-    // Create the node
-    auto node = std::make_shared<SceneNode>(id, name, status);
+    bool start_object(std::size_t) override {
+        if (m_skip > 0) {
+            ++m_skip;
+        } else if (m_frames.empty()) {
+            if (m_done) return false;
+            pushNode(true);
+        } else if (m_frames.back().kind == Kind::Children ||
+                   (m_frames.back().kind == Kind::Node && m_frames.back().field == Field::Root)) {
+            pushNode(false);
+        } else {
+            ++m_skip; // Unknown property, or an object inside "tags"
+        }
+        return true;
+    }
 
-    // --- Tags ---
-    if (val.contains("tags") && val["tags"].is_array()) {
-        for (const auto& tag : val["tags"]) {
-            if (tag.is_string()) {
-                node->addTag(tag.get<std::string>());
-            }
+    bool end_object() override {
+        if (m_skip > 0) {
+            --m_skip;
+            return true;
         }
+        Frame frame = std::move(m_frames.back());
+        m_frames.pop_back();
+        if (frame.isDocument) {
+            m_document = std::move(frame);
+            m_done = true;
+            return true;
+        }
+
+        std::shared_ptr<SceneNode> node = buildNode(frame);
+        Frame& parent = m_frames.back();
+        if (parent.kind == Kind::Children) {
+            if (node) m_frames[parent.owner].children.push_back(std::move(node));
+        } else {
+            parent.root = std::move(node);
+            parent.field = Field::Other;
+        }
+        return true;
     }
 
-    // --- Future Extensions ---
-    // Parse additional properties here
-
-    // --- Children (Recursive) ---
-    if (val.contains("children") && val["children"].is_array()) {
-        for (const auto& childVal : val["children"]) {
-            auto childNode = deserializeNode(childVal, version);
-            if (childNode) {
-                node->addChild(childNode);
+    bool start_array(std::size_t) override {
+        if (m_frames.empty()) return false; // The document must be an object
+        Frame* node = currentNode();
+        if (node && node->field == Field::Tags) {
+            pushFrame(Kind::Tags);
+        } else if (node && node->field == Field::Children) {
+            pushFrame(Kind::Children);
+        } else {
+            ++m_skip;
+        }
+        return true;
+    }
+
+    bool end_array() override {
+        if (m_skip > 0) {
+            --m_skip;
+        } else {
+            m_frames.pop_back();
+            m_frames.back().field = Field::Other;
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        std::cerr << "[SceneIO] " << m_label << " Parse Error: " << ex.what() << std::endl;
+        return false;
+    }
+
+private:
+    enum class Kind { Node, Tags, Children };
+    enum class Field { Other, Id, Key, Ref, Name, Status, Visible, Tags, Children, FormatVersion, Root };
+
+    struct Frame {
+        explicit Frame(Kind frameKind) : kind(frameKind) {}
+
+        Kind kind;
+        Field field = Field::Other; // Key of the value being read (Node frames)
+        size_t owner = 0;           // Stack index of the node whose "tags"/"children" array this is
+        bool isDocument = false;
+
+        // Node properties, defaulted like the DOM loader did
+        std::optional<ObjectId> id;
+        std::optional<uint32_t> sharedKey; // Set on a node that later entries refer to
+        std::optional<uint32_t> ref;       // Set for a reference to an earlier node
+        StringAtom name;
+        ObjectStatus status = ObjectStatus::Active;
+        bool visible = true;
+        std::vector<StringAtom> tags;
+        std::vector<std::shared_ptr<SceneNode>> children;
+
+        // Document wrapper ("format_version"/"root")
+        bool versioned = false;
+        int version = 0;
+        std::shared_ptr<SceneNode> root;
+    };
+
+    static StringAtom unnamed() {
+        static const StringAtom atom = StringAtom::intern("Unnamed");
+        return atom;
+    }
+
+    // 'versioned' drops the node keys of a document already known to be a wrapper
+    static Field fieldFor(const std::string& key, bool isDocument, bool versioned) {
+        if (isDocument && key == "format_version") return Field::FormatVersion;
+        if (isDocument && key == "root") return Field::Root;
+        if (isDocument && versioned) return Field::Other;
+        if (key == "id") return Field::Id;
+        if (!isDocument && key == "key") return Field::Key;
+        if (!isDocument && key == "ref") return Field::Ref;
+        if (key == "name") return Field::Name;
+        if (key == "status") return Field::Status;
+        if (key == "visible") return Field::Visible;
+        if (key == "tags") return Field::Tags;
+        if (key == "children") return Field::Children;
+        return Field::Other;
+    }
+
+    // The node frame whose property value comes next, or nullptr inside arrays and skipped values
+    Frame* currentNode() {
+        if (m_skip > 0 || m_frames.empty() || m_frames.back().kind != Kind::Node) return nullptr;
+        return &m_frames.back();
+    }
+
+    bool scalar() {
+        if (m_frames.empty() && m_skip == 0) return false; // The document must be an object
+        if (Frame* node = currentNode()) node->field = Field::Other;
+        return true;
+    }
+
+    void pushNode(bool isDocument) {
+        m_frames.emplace_back(Kind::Node);
+        m_frames.back().isDocument = isDocument;
+        m_frames.back().name = unnamed();
+    }
+
+    // Opens the "tags" or "children" array of the node frame on top of the stack
+    void pushFrame(Kind kind) {
+        size_t owner = m_frames.size() - 1;
+        m_frames.emplace_back(kind);
+        m_frames.back().owner = owner;
+    }
+
+    static void setId(Frame& node, number_unsigned_t val) {
+        if (node.field == Field::Id) node.id = ObjectId(static_cast<unsigned int>(val));
+        if (node.field == Field::Key) node.sharedKey = static_cast<uint32_t>(val);
+        if (node.field == Field::Ref) node.ref = static_cast<uint32_t>(val);
+    }
+
+    // A version settles the document as a wrapper, so the legacy reading built so far is dropped
+    static void setVersion(Frame& node, number_integer_t val) {
+        node.versioned = true;
+        node.version = static_cast<int>(val);
+        node.tags.clear();
+        node.children.clear();
+    }
+
+    // Warnings from inside the document are held back until it is known which reading they belong to
+    void warn(std::string message) {
+        if (!m_frames.empty() && !m_frames.front().versioned) {
+            m_deferred.emplace_back(m_frames.front().field, std::move(message));
+            return;
+        }
+        std::cerr << "[SceneIO] Warning: " << message << std::endl;
+    }
+
+    std::shared_ptr<SceneNode> buildNode(Frame& frame) {
+        if (frame.ref) {
+            // A keyed node whose parent was dropped is gone by the time it is referenced
+            auto it = m_shared.find(*frame.ref);
+            std::shared_ptr<SceneNode> shared = it != m_shared.end() ? it->second.lock() : nullptr;
+            if (!shared) {
+                warn("Reference to unknown node key (" + std::to_string(*frame.ref) + ").");
             }
+            return shared;
+        }
+        if (!frame.id) {
+            warn("Node missing valid 'id'.");
+            return nullptr;
         }
+        auto node = SceneNodePool::makeNode(m_pool, *frame.id, frame.name, frame.status);
+        for (StringAtom tag : frame.tags) node->addTag(tag);
+        if (!frame.visible) node->setVisible(false);
+        if (!frame.children.empty()) node->addChildren(frame.children);
+        if (frame.sharedKey) {
+            // The first live node with a key wins
+            auto [entry, inserted] = m_shared.try_emplace(*frame.sharedKey, node);
+            if (!inserted && entry->second.expired()) entry->second = node;
+        }
+        return node;
     }
 
-    return node;
-}
+    std::shared_ptr<SceneNodePool> m_pool;
+    const char* m_label;
+    std::vector<Frame> m_frames;
+    // Nodes built so far by "key", for resolving references. Weak, so that a node dropped with
+    // its parent expires instead of dangling.
+    IndexMap<uint32_t, std::weak_ptr<SceneNode>> m_shared;
+    size_t m_skip = 0; // Nesting depth inside a value that is being ignored
+    Frame m_document{Kind::Node};
+    std::vector<std::pair<Field, std::string>> m_deferred; // Held-back warnings and the document key they came under
+    bool m_done = false;
+};
 
-std::unique_ptr<SceneTree> SceneIO::loadSceneTree(const std::string& filepath) {
-    std::ifstream ifs(filepath);
-    if (!ifs.is_open()) {
-        std::cerr << "[SceneIO] Error: Could not open file for reading: " << filepath << std::endl;
-        return nullptr;
+} // namespace
+
+// Warns about a newer format version and wraps the loaded root in a tree
+static std::unique_ptr<SceneTree> finishLoad(SceneSaxLoader& loader, const std::shared_ptr<SceneNodePool>& pool) {
+    int version = loader.version();
+    if (version > CURRENT_FORMAT_VERSION) {
+        std::cerr << "[SceneIO] Warning: File version (" << version << ") is newer than supported version (" << CURRENT_FORMAT_VERSION << ")." << std::endl;
     }
 
-    json doc;
-    try {
-        ifs >> doc;
-    } catch (const json::parse_error& e) {
-        std::cerr << "[SceneIO] JSON Parse Error: " << e.what() << std::endl;
+    std::shared_ptr<SceneNode> rootNode = loader.takeRoot();
+    if (!rootNode) {
         return nullptr;
     }
 
-    if (!doc.is_object()) {
-        return nullptr;
+    return std::make_unique<SceneTree>(rootNode, pool);
+}
+
+// nlohmann's input format and the error-message label of a document encoding
+static std::pair<json::input_format_t, const char*> documentEncoding(SceneFormat format) {
+    switch (format) {
+        case SceneFormat::Cbor: return {json::input_format_t::cbor, "CBOR"};
+        case SceneFormat::MessagePack: return {json::input_format_t::msgpack, "MessagePack"};
+        case SceneFormat::Ubjson: return {json::input_format_t::ubjson, "UBJSON"};
+        case SceneFormat::Bson: return {json::input_format_t::bson, "BSON"};
+        default: return {json::input_format_t::json, "JSON"};
     }
+}
 
-    std::shared_ptr<SceneNode> rootNode = nullptr;
-    int version = 0;
+std::optional<SceneFormat> SceneIO::detectFormat(const std::string& filepath) {
+    std::ifstream ifs(filepath, std::ios::binary | std::ios::ate);
+    if (!ifs.is_open()) return std::nullopt;
+    const std::streamoff fileSize = ifs.tellg();
+    ifs.seekg(0);
 
-    // Check for versioning
-    if (doc.contains("format_version") && doc["format_version"].is_number_integer()) {
-        version = doc["format_version"].get<int>();
-        
-        if (version > CURRENT_FORMAT_VERSION) {
-            std::cerr << "[SceneIO] Warning: File version (" << version << ") is newer than supported version (" << CURRENT_FORMAT_VERSION << ")." << std::endl;
+    unsigned char head[sizeof(SceneBinary::kMagic)] = {};
+    ifs.read(reinterpret_cast<char*>(head), sizeof(head));
+    const size_t headSize = static_cast<size_t>(ifs.gcount());
+    if (SceneBinary::isBinary(head, headSize)) return SceneFormat::Binary;
+    if (headSize == 0) return std::nullopt;
+
+    // BSON has no magic; a document starts with its little-endian total size and ends with 0
+    if (headSize == 4 && fileSize >= 5) {
+        uint32_t declared = uint32_t(head[0]) | uint32_t(head[1]) << 8 | uint32_t(head[2]) << 16 | uint32_t(head[3]) << 24;
+        char last = 1;
+        ifs.seekg(fileSize - 1);
+        ifs.get(last);
+        if (declared == static_cast<uint64_t>(fileSize) && last == 0) return SceneFormat::Bson;
+    }
+
+    // The other encodings are told apart by how they open the top-level object (a map)
+    const unsigned char first = head[0];
+    if ((first >= 0xA0 && first <= 0xBB) || first == 0xBF) return SceneFormat::Cbor;
+    if ((first >= 0x80 && first <= 0x8F) || first == 0xDE || first == 0xDF) return SceneFormat::MessagePack;
+    // UBJSON and JSON objects both open with '{'; UBJSON follows it with a count, a type or a
+    // key length marker instead of whitespace or a quote
+    if (first == '{' && headSize > 1 && head[1] != 0 && std::strchr("iUIlL#$", head[1])) return SceneFormat::Ubjson;
+
+    // JSON documents are objects: the first non-whitespace byte is '{'
+    ifs.clear();
+    ifs.seekg(0);
+    char c;
+    while (ifs.get(c)) {
+        if (c == '{') return SceneFormat::Json;
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+    }
+    return std::nullopt;
+}
+
+std::unique_ptr<SceneTree> SceneIO::loadSceneTree(const std::string& filepath) {
+    // Unrecognized files go to the JSON reader, which reports why they do not parse
+    return loadSceneTree(filepath, detectFormat(filepath).value_or(SceneFormat::Json));
+}
+
+std::unique_ptr<SceneTree> SceneIO::loadSceneTree(const std::string& filepath, SceneFormat format) {
+    if (format != SceneFormat::Json && format != SceneFormat::CompactJson) {
+        MappedFile file(filepath);
+        if (!file.isOpen()) {
+            std::cerr << "[SceneIO] Error: Could not map file for reading: " << filepath << std::endl;
+            return nullptr;
+        }
+        if (format == SceneFormat::Binary) {
+            return SceneBinary::decode(file.data(), file.size());
         }
 
-        if (doc.contains("root")) {
-            rootNode = deserializeNode(doc["root"], version);
+        auto [inputFormat, label] = documentEncoding(format);
+        auto pool = std::make_shared<SceneNodePool>();
+        SceneSaxLoader loader(pool, label);
+        if (!json::sax_parse(file.data(), file.data() + file.size(), &loader, inputFormat)) {
+            return nullptr;
         }
-    } else {
-        // Legacy format: The document root is the SceneNode
-        rootNode = deserializeNode(doc, 0);
+        return finishLoad(loader, pool);
     }
 
-    if (!rootNode) {
+    std::ifstream ifs(filepath);
+    if (!ifs.is_open()) {
+        std::cerr << "[SceneIO] Error: Could not open file for reading: " << filepath << std::endl;
         return nullptr;
     }
 
-    return std::make_unique<SceneTree>(rootNode);
-}
\ No newline at end of file
+    auto pool = std::make_shared<SceneNodePool>();
+    SceneSaxLoader loader(pool, "JSON");
+    // Not strict, like 'ifs >> doc': content after the document is not read
+    if (!json::sax_parse(ifs, &loader, json::input_format_t::json, false)) {
+        return nullptr;
+    }
+    return finishLoad(loader, pool);
+}
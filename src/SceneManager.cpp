@@ -65,6 +65,10 @@ SceneTree* SceneManager::getActiveSceneTree() const {
     return m_active_scene_tree.get();
 }
 
+task_engine::TaskExecutor& SceneManager::getTaskExecutor() const {
+    return *m_executor;
+}
+
 bool SceneManager::preloadScene(const std::string& sceneName, const std::string& filepath) {
     if (isSceneReady(sceneName)) {
         return true;
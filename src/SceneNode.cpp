@@ -2,19 +2,12 @@
 #include "SceneTree/SceneObject.h"
 #include <algorithm>
 #include <stdexcept>
-
-// Helper to check if 'potentialAncestor' is actually an ancestor of 'node'
-static bool isNodeAncestor(const SceneNode* potentialAncestor, const SceneNode* node) {
-    if (potentialAncestor == node) return true;
-    for (const auto& weakParent : node->getParents()) {
-        if (auto parent = weakParent.lock()) {
-            if (isNodeAncestor(potentialAncestor, parent.get())) return true;
-        }
-    }
-    return false;
-}
+#include <unordered_set>
 
 SceneNode::SceneNode(ObjectId id, const std::string& name, ObjectStatus status)
+    : m_id(id), m_name(StringAtom::intern(name)), m_status(status) {}
+
+SceneNode::SceneNode(ObjectId id, StringAtom name, ObjectStatus status)
     : m_id(id), m_name(name), m_status(status) {}
 
 ObjectId SceneNode::getId() const {
@@ -22,10 +15,18 @@ ObjectId SceneNode::getId() const {
 }
 
 const std::string& SceneNode::getName() const {
+    return m_name.str();
+}
+
+StringAtom SceneNode::getNameAtom() const {
     return m_name;
 }
 
 void SceneNode::setName(const std::string& name) {
+    setName(StringAtom::intern(name));
+}
+
+void SceneNode::setName(StringAtom name) {
     if (m_name == name) return;
     if (!isPropertyDirty(NodeProperty::Name)) {
         m_clean_name = m_name;
@@ -47,6 +48,19 @@ void SceneNode::setStatus(ObjectStatus status) {
     markDirty(NodeProperty::Status);
 }
 
+bool SceneNode::isVisible() const {
+    return m_visible;
+}
+
+void SceneNode::setVisible(bool visible) {
+    if (m_visible == visible) return;
+    if (!isPropertyDirty(NodeProperty::Visibility)) {
+        m_clean_visible = m_visible;
+    }
+    m_visible = visible;
+    markDirty(NodeProperty::Visibility);
+}
+
 void SceneNode::markDirty(NodeProperty prop) {
     bool was_clean = (m_dirty_flags == 0);
     m_dirty_flags |= static_cast<uint32_t>(prop);
@@ -55,7 +69,7 @@ void SceneNode::markDirty(NodeProperty prop) {
     // Subsequent updates are coalesced until clearDirty() is called.
     if (was_clean) {
         for (auto* observer : m_observers) {
-            observer->onNodePropertyChanged(this, NodeProperty::IsDirty, std::any(), std::any());
+            observer->onNodePropertyChanged(this, NodeProperty::IsDirty, PropertyValue(), PropertyValue());
         }
     }
 }
@@ -73,6 +87,10 @@ void SceneNode::clearDirty() {
 }
 
 const std::string& SceneNode::getCleanName() const {
+    return m_clean_name.str();
+}
+
+StringAtom SceneNode::getCleanNameAtom() const {
     return m_clean_name;
 }
 
@@ -80,27 +98,48 @@ ObjectStatus SceneNode::getCleanStatus() const {
     return m_clean_status;
 }
 
+bool SceneNode::getCleanVisible() const {
+    return m_clean_visible;
+}
+
 void SceneNode::addTag(const std::string& tag) {
-    if (m_tags.insert(tag).second) {
-        for (auto* observer : m_observers) {
-            observer->onNodePropertyChanged(this, NodeProperty::TagAdded, std::any(), tag);
-        }
+    addTag(StringAtom::intern(tag));
+}
+
+void SceneNode::addTag(StringAtom tag) {
+    if (hasTag(tag)) return;
+    m_tags.push_back(tag);
+    for (auto* observer : m_observers) {
+        observer->onNodePropertyChanged(this, NodeProperty::TagAdded, PropertyValue(), tag);
     }
 }
 
 void SceneNode::removeTag(const std::string& tag) {
-    if (m_tags.erase(tag) > 0) {
-        for (auto* observer : m_observers) {
-            observer->onNodePropertyChanged(this, NodeProperty::TagRemoved, tag, std::any());
-        }
+    StringAtom atom = StringAtom::find(tag);
+    if (atom.isValid()) {
+        removeTag(atom);
+    }
+}
+
+void SceneNode::removeTag(StringAtom tag) {
+    auto it = std::find(m_tags.begin(), m_tags.end(), tag);
+    if (it == m_tags.end()) return;
+    m_tags.erase(it);
+    for (auto* observer : m_observers) {
+        observer->onNodePropertyChanged(this, NodeProperty::TagRemoved, tag, PropertyValue());
     }
 }
 
 bool SceneNode::hasTag(const std::string& tag) const {
-    return m_tags.find(tag) != m_tags.end();
+    StringAtom atom = StringAtom::find(tag);
+    return atom.isValid() && hasTag(atom);
 }
 
-const std::unordered_set<std::string>& SceneNode::getTags() const {
+bool SceneNode::hasTag(StringAtom tag) const {
+    return std::find(m_tags.begin(), m_tags.end(), tag) != m_tags.end();
+}
+
+const std::vector<StringAtom>& SceneNode::getTags() const {
     return m_tags;
 }
 
@@ -113,6 +152,58 @@ void SceneNode::unregisterObserver(INodeObserver* observer) {
     m_observers.erase(std::remove(m_observers.begin(), m_observers.end(), observer), m_observers.end());
 }
 
+// True if 'candidate' is this node or one of its ancestors. Ranks strictly increase from parent
+// to child, so a parent ranked below 'candidate' cannot lead to it and is not expanded. Each
+// ancestor is expanded at most once.
+bool SceneNode::hasAncestor(const SceneNode* candidate) const {
+    if (candidate == this) return true;
+    if (candidate->m_topo_rank >= m_topo_rank || candidate->m_children.empty()) return false;
+
+    std::vector<const SceneNode*> stack{this};
+    std::unordered_set<const SceneNode*> visited{this};
+    while (!stack.empty()) {
+        const SceneNode* node = stack.back();
+        stack.pop_back();
+        for (const auto& weakParent : node->m_parents) {
+            auto parent = weakParent.lock();
+            if (!parent || parent->m_topo_rank < candidate->m_topo_rank) continue;
+            if (parent.get() == candidate) return true;
+            if (visited.insert(parent.get()).second) {
+                stack.push_back(parent.get());
+            }
+        }
+    }
+    return false;
+}
+
+// Restores rank(this) < rank(child) for a new edge in O(1) in the two ways scenes are built:
+// top-down (the child is new, so raising it touches only the child) and bottom-up (this node
+// has no parents yet, so it can move below the child without breaking any other edge).
+// Only when an existing subtree is linked below an existing parent is the subtree walked.
+void SceneNode::orderBefore(SceneNode* child) {
+    if (m_topo_rank < child->m_topo_rank) return;
+    if (m_parents.empty()) {
+        m_topo_rank = child->m_topo_rank - 1;
+    } else {
+        child->raiseRank(m_topo_rank + 1);
+    }
+}
+
+// Restores rank(parent) < rank(child) below a new edge. Only nodes whose rank actually has to
+// grow are touched.
+void SceneNode::raiseRank(int64_t minRank) {
+    std::vector<std::pair<SceneNode*, int64_t>> stack{{this, minRank}};
+    while (!stack.empty()) {
+        auto [node, rank] = stack.back();
+        stack.pop_back();
+        if (node->m_topo_rank >= rank) continue;
+        node->m_topo_rank = rank;
+        for (const auto& child : node->m_children) {
+            if (child) stack.push_back({child.get(), rank + 1});
+        }
+    }
+}
+
 void SceneNode::addChild(std::shared_ptr<SceneNode> child) {
     if (!child) return;
     
@@ -121,20 +212,78 @@ void SceneNode::addChild(std::shared_ptr<SceneNode> child) {
         throw std::invalid_argument("A node cannot be its own child.");
     }
 
-    // Check for cycles: ensure 'this' is not an ancestor of 'child'
-    if (isNodeAncestor(child.get(), this)) {
+    // Check for cycles: ensure 'child' is not an ancestor of 'this'
+    if (hasAncestor(child.get())) {
         throw std::runtime_error("Cycle detected: Cannot add an ancestor as a child.");
     }
     
     m_children.push_back(child);
     child->addParent(weak_from_this());
+    orderBefore(child.get());
+
+    for (auto* observer : m_observers) {
+        observer->onNodePropertyChanged(this, NodeProperty::Hierarchy, PropertyValue(), child->getId());
+    }
+}
+
+void SceneNode::addChildren(const std::vector<std::shared_ptr<SceneNode>>& children) {
+    // Validate everything first so that a rejected batch leaves the hierarchy untouched.
+    // The ancestors of this node are collected once and shared by all checks.
+    std::unordered_set<const SceneNode*> ancestors;
+    bool ancestorsCollected = false;
+    for (const auto& child : children) {
+        if (!child) continue;
+        if (child.get() == this) {
+            throw std::invalid_argument("A node cannot be its own child.");
+        }
+        if (child->m_topo_rank >= m_topo_rank || child->m_children.empty()) {
+            continue; // Cannot be an ancestor
+        }
+        if (!ancestorsCollected) {
+            std::vector<const SceneNode*> stack{this};
+            while (!stack.empty()) {
+                const SceneNode* node = stack.back();
+                stack.pop_back();
+                for (const auto& weakParent : node->m_parents) {
+                    auto parent = weakParent.lock();
+                    if (parent && ancestors.insert(parent.get()).second) {
+                        stack.push_back(parent.get());
+                    }
+                }
+            }
+            ancestorsCollected = true;
+        }
+        if (ancestors.count(child.get())) {
+            throw std::runtime_error("Cycle detected: Cannot add an ancestor as a child.");
+        }
+    }
+
+    m_children.reserve(m_children.size() + children.size());
+    for (const auto& child : children) {
+        if (!child) continue;
+        m_children.push_back(child);
+        child->addParent(weak_from_this());
+        orderBefore(child.get());
+    }
+
+    for (const auto& child : children) {
+        if (!child) continue;
+        for (auto* observer : m_observers) {
+            observer->onNodePropertyChanged(this, NodeProperty::Hierarchy, PropertyValue(), child->getId());
+        }
+    }
 }
 
 bool SceneNode::removeChild(const std::shared_ptr<SceneNode>& child) {
     auto it = std::find(m_children.begin(), m_children.end(), child);
     if (it != m_children.end()) {
-        (*it)->removeParent(weak_from_this());
+        std::shared_ptr<SceneNode> removed = *it; // Observers may still look at the child
+        removed->removeParent(weak_from_this());
+        ObjectId childId = removed->getId();
         m_children.erase(it);
+        for (auto* observer : m_observers) {
+            observer->onNodePropertyChanged(this, NodeProperty::Hierarchy, childId, PropertyValue());
+        }
         return true;
     }
     return false;
@@ -160,29 +309,56 @@ void SceneNode::removeParent(const std::weak_ptr<SceneNode>& parent) {
 }
 
 std::shared_ptr<SceneNode> SceneNode::findFirstChildNodeByName(const std::string& name) const {
-    for (const auto& child : m_children) {
-        if (child) {
-            if (child->getName() == name) {
-                return child;
-            }
-            if (auto found = child->findFirstChildNodeByName(name)) {
-                return found;
-            }
+    StringAtom atom = StringAtom::find(name);
+    return atom.isValid() ? findFirstChildNodeByName(atom) : nullptr;
+}
+
+std::shared_ptr<SceneNode> SceneNode::findFirstChildNodeByName(StringAtom name) const {
+    for (SceneNode* node : preOrder()) {
+        if (node != this && node->m_name == name) {
+            return node->shared_from_this();
         }
     }
     return nullptr;
 }
 
 std::vector<std::shared_ptr<SceneNode>> SceneNode::findAllChildNodesByName(const std::string& name) const {
+    StringAtom atom = StringAtom::find(name);
+    return atom.isValid() ? findAllChildNodesByName(atom) : std::vector<std::shared_ptr<SceneNode>>();
+}
+
+std::vector<std::shared_ptr<SceneNode>> SceneNode::findAllChildNodesByName(StringAtom name) const {
     std::vector<std::shared_ptr<SceneNode>> results;
-    for (const auto& child : m_children) {
-        if (child) {
-            if (child->getName() == name) {
-                results.push_back(child);
-            }
-            auto child_results = child->findAllChildNodesByName(name);
-            results.insert(results.end(), child_results.begin(), child_results.end());
+    for (SceneNode* node : preOrder()) {
+        if (node != this && node->m_name == name) {
+            results.push_back(node->shared_from_this());
         }
     }
     return results;
 }
+
+void SceneNode::findAllChildNodesByName(const std::string& name, std::vector<SceneNode*>& out) const {
+    findAllChildNodesByName(StringAtom::find(name), out);
+}
+
+void SceneNode::findAllChildNodesByName(StringAtom name, std::vector<SceneNode*>& out) const {
+    out.clear();
+    if (!name.isValid()) return;
+    for (SceneNode* node : preOrder()) {
+        if (node != this && node->m_name == name) {
+            out.push_back(node);
+        }
+    }
+}
+
+PreOrderRange SceneNode::preOrder(VisitMode mode) const {
+    return PreOrderRange(const_cast<SceneNode*>(this), mode);
+}
+
+PostOrderRange SceneNode::postOrder(VisitMode mode) const {
+    return PostOrderRange(const_cast<SceneNode*>(this), mode);
+}
+
+BreadthFirstRange SceneNode::breadthFirst(VisitMode mode) const {
+    return BreadthFirstRange(const_cast<SceneNode*>(this), mode);
+}
@@ -0,0 +1,168 @@
+#include "SceneTree/SceneNodePool.h"
+#include "SceneTree/SceneNode.h"
+#include <algorithm>
+
+static constexpr size_t kSlotAlignment = alignof(std::max_align_t);
+
+static size_t roundUpToSlot(size_t bytes) {
+    return (bytes + kSlotAlignment - 1) & ~(kSlotAlignment - 1);
+}
+
+void SceneNodePool::PageDeleter::operator()(std::byte* page) const {
+    ::operator delete(page, std::align_val_t(kSlotAlignment));
+}
+
+SceneNodePool::SceneNodePool(size_t nodesPerPage)
+    : m_nodes_per_page(std::max<size_t>(nodesPerPage, 1)) {}
+
+// All nodes hold a reference to the pool through their allocator, so by the time the pool is
+// destroyed every slot has already been returned and the pages can be released in one sweep.
+SceneNodePool::~SceneNodePool() = default;
+
+std::shared_ptr<SceneNode> SceneNodePool::makeNode(const std::shared_ptr<SceneNodePool>& pool, ObjectId id,
+                                                   const std::string& name, ObjectStatus status) {
+    if (!pool) {
+        return std::make_shared<SceneNode>(id, name, status);
+    }
+    return std::allocate_shared<SceneNode>(SceneNodePoolAllocator<SceneNode>(pool), id, name, status);
+}
+
+std::shared_ptr<SceneNode> SceneNodePool::makeNode(const std::shared_ptr<SceneNodePool>& pool, ObjectId id,
+                                                   StringAtom name, ObjectStatus status) {
+    if (!pool) {
+        return std::make_shared<SceneNode>(id, name, status);
+    }
+    return std::allocate_shared<SceneNode>(SceneNodePoolAllocator<SceneNode>(pool), id, name, status);
+}
+
+void SceneNodePool::reserve(size_t count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_reserved_nodes = std::max(m_reserved_nodes, count);
+    if (m_slot_size == 0) {
+        return; // Page size is unknown until the first allocation
+    }
+
+    size_t available = bumpSlots();
+    for (FreeSlot* slot = m_free_list; slot && available < count; slot = slot->next) {
+        ++available;
+    }
+    if (available < count) {
+        m_reserved_nodes = count - available;
+        addPage();
+    }
+    m_reserved_nodes = 0;
+}
+
+bool SceneNodePool::ownsSize(size_t bytes, size_t alignment) const {
+    return alignment <= kSlotAlignment && (m_slot_size == 0 || roundUpToSlot(bytes) == m_slot_size);
+}
+
+// Whole slots left between the bump pointer and the end of the current page (none before the
+// first page exists)
+size_t SceneNodePool::bumpSlots() const {
+    return m_bump ? static_cast<size_t>(m_bump_end - m_bump) / m_slot_size : 0;
+}
+
+void SceneNodePool::addPage() {
+    // Hand the unused tail of the current page to the free list before switching pages
+    for (size_t tail = bumpSlots(); tail > 0; --tail) {
+        auto* slot = reinterpret_cast<FreeSlot*>(m_bump);
+        slot->next = m_free_list;
+        m_free_list = slot;
+        m_bump += m_slot_size;
+    }
+
+    size_t slots = std::max(m_nodes_per_page, m_reserved_nodes);
+    size_t bytes = slots * m_slot_size;
+    auto* page = static_cast<std::byte*>(::operator new(bytes, std::align_val_t(kSlotAlignment)));
+    m_pages.emplace_back(page);
+    m_bump = page;
+    m_bump_end = page + bytes;
+}
+
+void* SceneNodePool::allocate(size_t bytes, size_t alignment) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!ownsSize(bytes, alignment)) {
+        // Not a node slot (should not happen with allocate_shared<SceneNode>); use the global heap
+        return ::operator new(bytes, std::align_val_t(std::max(alignment, kSlotAlignment)));
+    }
+    if (m_slot_size == 0) {
+        m_slot_size = roundUpToSlot(std::max(bytes, sizeof(FreeSlot)));
+    }
+
+    ++m_live;
+    if (m_free_list) {
+        FreeSlot* slot = m_free_list;
+        m_free_list = slot->next;
+        return slot;
+    }
+    if (bumpSlots() == 0) {
+        addPage();
+        m_reserved_nodes = 0;
+    }
+    void* result = m_bump;
+    m_bump += m_slot_size;
+    return result;
+}
+
+void SceneNodePool::deallocate(void* ptr, size_t bytes, size_t alignment) {
+    if (!ptr) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!ownsSize(bytes, alignment)) {
+        ::operator delete(ptr, std::align_val_t(std::max(alignment, kSlotAlignment)));
+        return;
+    }
+    // During bulk release the slot is parked on its own list: endBulkRelease() either drops
+    // every page at once or, if some nodes survived, hands the parked slots to the free list
+    auto* slot = static_cast<FreeSlot*>(ptr);
+    FreeSlot*& list = m_bulk_release ? m_bulk_freed : m_free_list;
+    slot->next = list;
+    list = slot;
+    --m_live;
+}
+
+void SceneNodePool::beginBulkRelease() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bulk_release = true;
+}
+
+void SceneNodePool::endBulkRelease() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_bulk_release = false;
+    if (m_live == 0) {
+        m_pages.clear();
+        m_free_list = nullptr;
+        m_bulk_freed = nullptr;
+        m_bump = nullptr;
+        m_bump_end = nullptr;
+        return;
+    }
+    // Some nodes are still shared with another tree, so their pages stay alive. Only the slots
+    // released during the bulk pass are dead; they become reusable.
+    while (m_bulk_freed) {
+        FreeSlot* slot = m_bulk_freed;
+        m_bulk_freed = slot->next;
+        slot->next = m_free_list;
+        m_free_list = slot;
+    }
+}
+
+size_t SceneNodePool::liveCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_live;
+}
+
+size_t SceneNodePool::pageCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pages.size();
+}
+
+size_t SceneNodePool::capacity() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_slot_size == 0) return 0;
+    size_t free_slots = bumpSlots();
+    for (FreeSlot* slot = m_free_list; slot; slot = slot->next) {
+        ++free_slots;
+    }
+    return m_live + free_slots;
+}
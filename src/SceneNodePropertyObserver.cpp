@@ -1,18 +1,34 @@
 #include "SceneTree/SceneNodePropertyObserver.h"
 #include "SceneTree.h"
 
-void SceneNodePropertyObserver::onNodePropertyChanged(SceneNode* node, NodeProperty prop, const std::any& oldVal, const std::any& newVal) {
+void SceneNodePropertyObserver::onNodePropertyChanged(SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal) {
     if (!m_tree) return;
 
+    // Nodes may be modified from several executor threads during SceneTree::parallelVisit
+    std::unique_lock<std::recursive_mutex> lock(m_tree->m_parallel_mutex, std::defer_lock);
+    if (m_tree->m_parallel_pass) {
+        lock.lock();
+    }
+
     if (prop == NodeProperty::IsDirty) {
         m_tree->m_dirty_nodes.push_back(node->weak_from_this());
-        if (!m_tree->m_batching_enabled) {
+        if (!m_tree->m_batching_enabled && m_tree->m_edit_depth == 0) {
             m_tree->processEvents();
         }
         return;
     }
 
-    if (m_tree->m_batching_enabled) {
+    if (prop == NodeProperty::Hierarchy) {
+        // Structural caches must never see a stale hierarchy, even while batching
+        m_tree->invalidateHierarchyCaches();
+        if (newVal.has_value()) {
+            m_tree->onChildLinked(newVal.get<ObjectId>());
+        } else if (oldVal.has_value()) {
+            m_tree->onChildUnlinked(oldVal.get<ObjectId>());
+        }
+    }
+
+    if (m_tree->m_batching_enabled || m_tree->m_edit_depth > 0) {
         m_tree->m_event_queue.push_back({node->weak_from_this(), prop, oldVal, newVal});
     } else {
         m_tree->handlePropertyChange(node, prop, oldVal, newVal);
@@ -0,0 +1,107 @@
+#include "SceneTree/SceneTraversal.h"
+#include "SceneTree/SceneNode.h"
+
+bool SceneTraversalBase::markVisited(const SceneNode* node) {
+    if (m_mode == VisitMode::AllPaths || node->getParents().size() < 2) {
+        return true;
+    }
+    return m_visited.insert(node).second;
+}
+
+// --- Pre-order ---
+
+PreOrderIterator::PreOrderIterator(SceneNode* root, VisitMode mode) : SceneTraversalBase(mode) {
+    m_current = root; // Hierarchies are acyclic, so the root is never reached again
+}
+
+PreOrderIterator& PreOrderIterator::operator++() {
+    if (!m_current) return *this;
+
+    if (!m_skip_children) {
+        // Push in reverse so the first child is popped first
+        const auto& children = m_current->getChildren();
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            if (*it) m_stack.push_back({it->get(), m_depth + 1});
+        }
+    }
+    m_skip_children = false;
+
+    // A shared node may sit on the stack several times; it is yielded at the first pop
+    m_current = nullptr;
+    while (!m_stack.empty()) {
+        Frame frame = m_stack.back();
+        m_stack.pop_back();
+        if (markVisited(frame.node)) {
+            m_current = frame.node;
+            m_depth = frame.depth;
+            break;
+        }
+    }
+    return *this;
+}
+
+// --- Post-order ---
+
+PostOrderIterator::PostOrderIterator(SceneNode* root, VisitMode mode) : SceneTraversalBase(mode) {
+    if (root) {
+        m_stack.push_back({root, 0});
+        descend();
+    }
+}
+
+// Walks down from the top of the stack until it reaches a node whose children are all done
+void PostOrderIterator::descend() {
+    while (true) {
+        Frame& top = m_stack.back();
+        const auto& children = top.node->getChildren();
+        if (top.next_child == children.size()) {
+            break;
+        }
+        SceneNode* child = children[top.next_child++].get();
+        if (child && markVisited(child)) {
+            m_stack.push_back({child, 0});
+        }
+    }
+    m_current = m_stack.back().node;
+    m_depth = m_stack.size() - 1;
+}
+
+PostOrderIterator& PostOrderIterator::operator++() {
+    if (!m_current) return *this;
+
+    m_stack.pop_back();
+    if (m_stack.empty()) {
+        m_current = nullptr;
+    } else {
+        descend();
+    }
+    return *this;
+}
+
+// --- Breadth-first ---
+
+BreadthFirstIterator::BreadthFirstIterator(SceneNode* root, VisitMode mode) : SceneTraversalBase(mode) {
+    m_current = root;
+}
+
+BreadthFirstIterator& BreadthFirstIterator::operator++() {
+    if (!m_current) return *this;
+
+    if (!m_skip_children) {
+        for (const auto& child : m_current->getChildren()) {
+            // Marking at enqueue keeps a shared node out of the queue after its first parent
+            if (child && markVisited(child.get())) {
+                m_queue.push_back({child.get(), m_depth + 1});
+            }
+        }
+    }
+    m_skip_children = false;
+
+    m_current = nullptr;
+    if (!m_queue.empty()) {
+        m_current = m_queue.front().node;
+        m_depth = m_queue.front().depth;
+        m_queue.pop_front();
+    }
+    return *this;
+}
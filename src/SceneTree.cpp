@@ -1,22 +1,127 @@
 #include "SceneTree/SceneTree.h"
 #include "SceneTree/SceneNodePropertyObserver.h"
+#include "TaskEngine/TaskExecutor.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <queue>
+#include <exception>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 #include <algorithm>
 #include <unordered_set>
 #include <iostream>
 
-SceneTree::SceneTree(std::shared_ptr<SceneNode> root) : m_root(std::move(root)) {
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+SceneTree::SceneTree(std::shared_ptr<SceneNode> root, std::shared_ptr<SceneNodePool> pool)
+    : m_node_pool(std::move(pool)), m_root(std::move(root)) {
     if (!m_root) {
         throw std::invalid_argument("SceneTree root cannot be null.");
     }
+
     m_node_observer = std::make_unique<SceneNodePropertyObserver>(this);
+    // A pool handed over by a loader holds exactly the nodes about to be indexed
+    if (m_node_pool) reserveIndexes(m_node_pool->liveCount());
     buildNodeMap(m_root);
 }
+SceneTree::SceneTree(std::shared_ptr<SceneNode> root, DeferIndexing)
+    : m_root(std::move(root)) {
+    m_node_observer = std::make_unique<SceneNodePropertyObserver>(this);
+}
+
 SceneTree::~SceneTree() {
-    for (auto const& [id, node_ptr] : m_node_lookup) {
-        node_ptr->unregisterObserver(m_node_observer.get());
+    for (const auto& weakQuery : m_live_queries) {
+        if (auto query = weakQuery.lock()) {
+            query->m_tree = nullptr;
+            query->clear();
+        }
+    }
+    releaseNodes();
+}
+
+// Tears the tree down. Nodes that are exclusively owned by this tree die together with it, so
+// there is no need to unregister our observer from them one by one. Instead their child links
+// are cut and the nodes are destroyed in one flat pass (no recursive shared_ptr cascade) while
+// the node pool skips its free-list bookkeeping and drops its pages at the end.
+// Nodes that are still shared with another tree or held from outside take the regular path.
+void SceneTree::releaseNodes() {
+    if (!m_root) {
+        // The nodes were merged into another tree by attach(); they all stay alive.
+        for (SceneNode* node_ptr : m_slot_nodes) {
+            node_ptr->unregisterObserver(m_node_observer.get());
+        }
+        return;
+    }
+
+    // 1. Seed the shared set with nodes that are referenced from outside this tree: a node is
+    //    exclusive only if every strong reference to it comes from a parent inside this tree
+    //    (or from m_root) and no other tree observes it.
+    std::unordered_set<SceneNode*> sharedNodes;
+    std::vector<SceneNode*> queue;
+    for (uint32_t slot = 0; slot < m_slot_nodes.size(); ++slot) {
+        SceneNode* node_ptr = m_slot_nodes[slot];
+        long inTreeRefs = m_slot_refs[slot] + ((node_ptr == m_root.get()) ? 1 : 0);
+        long strongRefs = node_ptr->weak_from_this().use_count();
+        if (strongRefs != inTreeRefs || node_ptr->m_observers.size() != 1) {
+            if (sharedNodes.insert(node_ptr).second) {
+                queue.push_back(node_ptr);
+            }
+        }
+    }
+
+    // 2. Everything below a shared node is kept alive by it, so it is shared as well.
+    size_t head = 0;
+    while (head < queue.size()) {
+        SceneNode* curr = queue[head++];
+        for (const auto& child : curr->getChildren()) {
+            if (sharedNodes.insert(child.get()).second) {
+                queue.push_back(child.get());
+            }
+        }
+    }
+
+    // 3. Fallback path: shared nodes survive the tree and must stop reporting to it.
+    for (SceneNode* node : sharedNodes) {
+        node->unregisterObserver(m_node_observer.get());
+    }
+
+    // 4. Bulk path: detach the child lists of exclusive nodes so destruction does not recurse,
+    //    then release everything at once.
+    std::vector<std::shared_ptr<SceneNode>> graveyard;
+    graveyard.reserve(m_slot_nodes.size());
+    for (SceneNode* node_ptr : m_slot_nodes) {
+        if (sharedNodes.find(node_ptr) == sharedNodes.end()) {
+            for (auto& child : node_ptr->m_children) {
+                graveyard.push_back(std::move(child));
+            }
+            node_ptr->m_children.clear();
+        }
     }
+
+    if (m_node_pool) m_node_pool->beginBulkRelease();
+    m_node_lookup.clear();
+    m_slot_nodes.clear();
+    m_slot_tags.clear();
+    m_slot_refs.clear();
+    m_slot_name.clear();
+    m_slot_tag_refs.clear();
+    m_slot_linear.clear();
+    m_slot_effective.clear();
+    m_effective_pending.clear();
+    m_linear_order.clear();
+    m_linear_slots.clear();
+    m_name_lookup.clear();
+    m_tag_lookup.clear();
+    m_root.reset();
+    graveyard.clear();
+    if (m_node_pool) m_node_pool->endBulkRelease();
 }
 
 // Static factory function to create a SceneTree from a Scene
@@ -26,12 +131,17 @@ std::unique_ptr<SceneTree> SceneTree::createFromScene(const Scene& scene) {
         return nullptr;
     }
 
-    std::unordered_map<ObjectId, std::shared_ptr<SceneNode>> node_map;
+    IndexMap<ObjectId, std::shared_ptr<SceneNode>> node_map;
+    node_map.reserve(objects.size());
     std::shared_ptr<SceneNode> root = nullptr;
 
+    // All nodes of the tree are carved out of a single pool in scene order
+    auto pool = std::make_shared<SceneNodePool>();
+    pool->reserve(objects.size());
+
     // First pass: Create all nodes
     for (auto* obj : objects) {
-        node_map[obj->id] = std::make_shared<SceneNode>(obj->id, obj->name, obj->status);
+        node_map[obj->id] = SceneNodePool::makeNode(pool, obj->id, obj->name, obj->status);
     }
 
     // Second pass: Build hierarchy
@@ -47,108 +157,176 @@ std::unique_ptr<SceneTree> SceneTree::createFromScene(const Scene& scene) {
         }
     }
 
-    return root ? std::make_unique<SceneTree>(root) : nullptr;
+    return root ? std::make_unique<SceneTree>(root, pool) : nullptr;
+}
+
+std::shared_ptr<SceneNode> SceneTree::createNode(ObjectId id, const std::string& name, ObjectStatus status) {
+    if (!m_node_pool) {
+        m_node_pool = std::make_shared<SceneNodePool>();
+    }
+    return SceneNodePool::makeNode(m_node_pool, id, name, status);
+}
+
+const std::shared_ptr<SceneNodePool>& SceneTree::getNodePool() const {
+    return m_node_pool;
 }
 
 
 SceneNode* SceneTree::findNode(ObjectId id) {
     auto it = m_node_lookup.find(id);
     if (it != m_node_lookup.end()) {
-        return it->second;
+        return it->second.node;
     }
     return nullptr;
 }
 
+// Prefetch hook for findNodes; std::unordered_map (SCENETREE_STD_HASH_MAPS) has no usable one
+template <typename Map>
+static void prefetchLookup(const Map&, ObjectId) {}
+template <typename V>
+static void prefetchLookup(const FlatHashMap<ObjectId, V>& map, ObjectId id) {
+    map.prefetch(id);
+}
+
+void SceneTree::findNodes(Span<const ObjectId> ids, Span<SceneNode*> out) const {
+    if (out.size() < ids.size()) {
+        throw std::invalid_argument("findNodes output span is shorter than the id span.");
+    }
+    constexpr size_t kAhead = 16;
+    const size_t count = ids.size();
+    for (size_t i = 0; i < std::min(count, kAhead); ++i) prefetchLookup(m_node_lookup, ids[i]);
+    for (size_t i = 0; i < count; ++i) {
+        if (i + kAhead < count) prefetchLookup(m_node_lookup, ids[i + kAhead]);
+        auto it = m_node_lookup.find(ids[i]);
+        out[i] = it != m_node_lookup.end() ? it->second.node : nullptr;
+    }
+}
+
+bool SceneTree::containsNode(const SceneNode* node) const {
+    auto it = m_node_lookup.find(node->getId());
+    return it != m_node_lookup.end() && it->second.node == node;
+}
+
 std::shared_ptr<SceneNode> SceneTree::findNodeByName(const std::string& name) const {
+    return findNodeByName(StringAtom::find(name));
+}
+
+std::shared_ptr<SceneNode> SceneTree::findNodeByName(StringAtom name) const {
     auto it = m_name_lookup.find(name);
     if (it != m_name_lookup.end() && !it->second.empty()) {
-        return it->second.front()->shared_from_this();
+        return it->second.first()->shared_from_this();
     }
     return nullptr;
 }
 
 std::shared_ptr<SceneNode> SceneTree::findFirstChildNodeByName(const std::string& name) const {
-    if (!m_root) return nullptr;
-    if (m_root->getName() == name) return m_root;
+    return findFirstChildNodeByName(StringAtom::find(name));
+}
+
+std::shared_ptr<SceneNode> SceneTree::findFirstChildNodeByName(StringAtom name) const {
+    if (!m_root || !name.isValid()) return nullptr;
+    if (m_root->getNameAtom() == name) return m_root;
     return m_root->findFirstChildNodeByName(name);
 }
 
 std::vector<std::shared_ptr<SceneNode>> SceneTree::findAllNodesByName(const std::string& name) const {
+    return findAllNodesByName(StringAtom::find(name));
+}
+
+// Oldest first, matching findNodeByName
+static std::vector<std::shared_ptr<SceneNode>> inInsertionOrder(const NodeBucket& bucket) {
     std::vector<std::shared_ptr<SceneNode>> results;
-    auto it = m_name_lookup.find(name);
-    if (it != m_name_lookup.end()) {
-        for (auto* node : it->second) {
-            results.push_back(node->shared_from_this());
-        }
+    results.reserve(bucket.size());
+    for (uint32_t position = bucket.head(); position != NodeBucket::kNone; position = bucket.next(position)) {
+        results.push_back(bucket.at(position)->shared_from_this());
     }
     return results;
 }
 
+std::vector<std::shared_ptr<SceneNode>> SceneTree::findAllNodesByName(StringAtom name) const {
+    auto it = m_name_lookup.find(name);
+    return it != m_name_lookup.end() ? inInsertionOrder(it->second) : std::vector<std::shared_ptr<SceneNode>>();
+}
+
 std::shared_ptr<SceneNode> SceneTree::findFirstNodeByTag(const std::string& tag) const {
+    return findFirstNodeByTag(StringAtom::find(tag));
+}
+
+std::shared_ptr<SceneNode> SceneTree::findFirstNodeByTag(StringAtom tag) const {
     auto it = m_tag_lookup.find(tag);
     if (it != m_tag_lookup.end() && !it->second.empty()) {
-        return it->second.front()->shared_from_this();
+        return it->second.first()->shared_from_this();
     }
     return nullptr;
 }
 
 std::vector<std::shared_ptr<SceneNode>> SceneTree::findAllNodesByTag(const std::string& tag) const {
-    std::vector<std::shared_ptr<SceneNode>> results;
+    return findAllNodesByTag(StringAtom::find(tag));
+}
+
+std::vector<std::shared_ptr<SceneNode>> SceneTree::findAllNodesByTag(StringAtom tag) const {
     auto it = m_tag_lookup.find(tag);
-    if (it != m_tag_lookup.end()) {
-        results.reserve(it->second.size());
-        for (auto* node : it->second) {
-            results.push_back(node->shared_from_this());
-        }
-    }
-    return results;
+    return it != m_tag_lookup.end() ? inInsertionOrder(it->second) : std::vector<std::shared_ptr<SceneNode>>();
 }
 
-static bool isDescendant(SceneNode* node, SceneNode* ancestor) {
-    if (!node || !ancestor) return false;
+NodeSpan SceneTree::nodesByName(const std::string& name) const {
+    return nodesByName(StringAtom::find(name));
+}
 
-    // Use iterative BFS to avoid recursion depth limits and handle DAGs efficiently
-    std::vector<SceneNode*> queue;
-    std::unordered_set<SceneNode*> visited;
+NodeSpan SceneTree::nodesByName(StringAtom name) const {
+    auto it = m_name_lookup.find(name);
+    return it != m_name_lookup.end() ? it->second.nodes() : NodeSpan();
+}
+
+NodeSpan SceneTree::nodesByTag(const std::string& tag) const {
+    return nodesByTag(StringAtom::find(tag));
+}
 
-    queue.push_back(node);
-    visited.insert(node);
+NodeSpan SceneTree::nodesByTag(StringAtom tag) const {
+    auto it = m_tag_lookup.find(tag);
+    return it != m_tag_lookup.end() ? it->second.nodes() : NodeSpan();
+}
 
-    size_t head = 0;
-    while (head < queue.size()) {
-        SceneNode* current = queue[head++];
-        
-        for (const auto& weak_parent : current->getParents()) {
-            if (auto parent = weak_parent.lock()) {
-                if (parent.get() == ancestor) return true;
-                if (visited.insert(parent.get()).second) {
-                    queue.push_back(parent.get());
-                }
-            }
-        }
-    }
-    
-    return false;
+void SceneTree::findAllNodesByName(const std::string& name, std::vector<SceneNode*>& out) const {
+    findAllNodesByName(StringAtom::find(name), out);
+}
+
+void SceneTree::findAllNodesByName(StringAtom name, std::vector<SceneNode*>& out) const {
+    NodeSpan nodes = nodesByName(name);
+    out.assign(nodes.begin(), nodes.end());
+}
+
+void SceneTree::findAllNodesByTag(const std::string& tag, std::vector<SceneNode*>& out) const {
+    findAllNodesByTag(StringAtom::find(tag), out);
+}
+
+void SceneTree::findAllNodesByTag(StringAtom tag, std::vector<SceneNode*>& out) const {
+    NodeSpan nodes = nodesByTag(tag);
+    out.assign(nodes.begin(), nodes.end());
 }
 
 std::shared_ptr<SceneNode> SceneTree::findNodeByName(SceneNode* startNode, const std::string& name) const {
-    if (!startNode) return nullptr;
+    return findNodeByName(startNode, StringAtom::find(name));
+}
+
+std::shared_ptr<SceneNode> SceneTree::findNodeByName(SceneNode* startNode, StringAtom name) const {
+    if (!startNode || !name.isValid()) return nullptr;
 
     // Validate that startNode belongs to this tree
-    auto it = m_node_lookup.find(startNode->getId());
-    if (it == m_node_lookup.end() || it->second != startNode) {
+    if (!containsNode(startNode)) {
         return nullptr;
     }
 
-    if (startNode->getName() == name) {
+    if (startNode->getNameAtom() == name) {
         return startNode->shared_from_this();
     }
     
     auto name_it = m_name_lookup.find(name);
     if (name_it != m_name_lookup.end()) {
-        for (auto* node : name_it->second) {
-            if (isDescendant(node, startNode)) {
-                return node->shared_from_this();
+        const NodeBucket& bucket = name_it->second;
+        for (uint32_t position = bucket.head(); position != NodeBucket::kNone; position = bucket.next(position)) {
+            if (isAncestorOf(startNode, bucket.at(position))) {
+                return bucket.at(position)->shared_from_this();
             }
         }
     }
@@ -156,28 +334,22 @@ std::shared_ptr<SceneNode> SceneTree::findNodeByName(SceneNode* startNode, const
 }
 
 std::vector<std::shared_ptr<SceneNode>> SceneTree::findAllNodesByName(SceneNode* startNode, const std::string& name) const {
+    return findAllNodesByName(startNode, StringAtom::find(name));
+}
+
+std::vector<std::shared_ptr<SceneNode>> SceneTree::findAllNodesByName(SceneNode* startNode, StringAtom name) const {
     std::vector<std::shared_ptr<SceneNode>> results;
-    if (!startNode) return results;
+    forEachNodeByName(startNode, name, [&results](SceneNode* node) { results.push_back(node->shared_from_this()); });
+    return results;
+}
 
-    // Validate that startNode belongs to this tree
-    auto it = m_node_lookup.find(startNode->getId());
-    if (it == m_node_lookup.end() || it->second != startNode) {
-        return results;
-    }
+void SceneTree::findAllNodesByName(SceneNode* startNode, const std::string& name, std::vector<SceneNode*>& out) const {
+    findAllNodesByName(startNode, StringAtom::find(name), out);
+}
 
-    if (startNode->getName() == name) {
-        results.push_back(startNode->shared_from_this());
-    }
-    
-    auto name_it = m_name_lookup.find(name);
-    if (name_it != m_name_lookup.end()) {
-        for (auto* node : name_it->second) {
-            if (node != startNode && isDescendant(node, startNode)) {
-                results.push_back(node->shared_from_this());
-            }
-        }
-    }
-    return results;
+void SceneTree::findAllNodesByName(SceneNode* startNode, StringAtom name, std::vector<SceneNode*>& out) const {
+    out.clear();
+    forEachNodeByName(startNode, name, [&out](SceneNode* node) { out.push_back(node); });
 }
 
 bool SceneTree::attach(SceneNode* parentNode, std::unique_ptr<SceneTree> childTree) {
@@ -185,28 +357,56 @@ bool SceneTree::attach(SceneNode* parentNode, std::unique_ptr<SceneTree> childTr
         return false;
     }
 
-    // Ensure the parentNode is actually part of this tree
+    // Ensure the parentNode is actually part of this tree (or of a subtree attached in this edit)
     if (findNode(parentNode->getId()) != parentNode) {
-        return false;
+        auto pending_it = m_edit_pending.find(parentNode->getId());
+        if (pending_it == m_edit_pending.end() || pending_it->second != parentNode) {
+            return false;
+        }
     }
 
     // Check for ID collisions before modifying the tree
-    for (auto const& [id, node_ptr] : childTree->m_node_lookup) {
+    for (auto const& [id, entry] : childTree->m_node_lookup) {
         auto it = m_node_lookup.find(id);
         if (it != m_node_lookup.end()) {
-            if (it->second != node_ptr) {
+            if (it->second.node != entry.node) {
                 return false; // ID collision: same ID but different object instance
             }
         }
+        auto pending_it = m_edit_pending.find(id);
+        if (pending_it != m_edit_pending.end() && pending_it->second != entry.node) {
+            return false;
+        }
     }
 
     // Transfer ownership and structure
     std::shared_ptr<SceneNode> childRoot = childTree->getRoot();
+    bool linearWasClean = !m_linear_dirty;
     parentNode->addChild(childRoot);
+    if (m_journal) {
+        m_journal->record(parentNode->getId(), ChangeKind::Attach, NodeProperty::Hierarchy, PropertyValue(), childRoot->getId());
+    }
+
+    if (m_edit_depth > 0) {
+        // Indexed at commit, together with everything else attached in this edit
+        for (auto const& [id, entry] : childTree->m_node_lookup) {
+            if (!containsNode(entry.node)) m_edit_pending.emplace(id, entry.node);
+        }
+        m_edit_roots.push_back(childRoot);
+        childTree->m_root = nullptr;
+        return true;
+    }
 
     // Merge the node maps using DFS traversal to ensure deterministic order
+    reserveIndexes(m_slot_nodes.size() + childTree->m_slot_nodes.size());
     buildNodeMap(childRoot);
 
+    // A subtree that is new to this tree goes at the end of the linear order, after its parent
+    if (linearWasClean) {
+        uint32_t parentIndex = m_slot_linear[m_node_lookup[parentNode->getId()].slot];
+        m_linear_dirty = parentIndex == kNoSlot || !appendLinearOrder(childRoot.get(), parentIndex);
+    }
+
     // The childTree unique_ptr is now empty, its resources are merged.
     childTree->m_root = nullptr;
 
@@ -218,85 +418,62 @@ std::unique_ptr<SceneTree> SceneTree::detach(SceneNode* parentNode, SceneNode* c
         return nullptr;
     }
     
+    // The release logic below relies on up-to-date buckets and reference counts
+    if (m_edit_depth > 0) {
+        flushEdit();
+    }
+
     auto childSharedPtr = childNode->shared_from_this();
+    bool linearWasClean = !m_linear_dirty;
 
-    if (!parentNode->removeChild(childSharedPtr)) {
+    // The Hierarchy event drops the child's in-tree reference count; releasing is done below
+    m_detaching = true;
+    bool removed = parentNode->removeChild(childSharedPtr);
+    m_detaching = false;
+    if (!removed) {
         // The childNode is not a direct child of parentNode.
         return nullptr;
     }
-
-    // Create a new SceneTree for the detached part.
-    // The SceneTree constructor will rebuild the node map for the detached subtree.
-    auto detachedTree = std::make_unique<SceneTree>(childSharedPtr);
+    if (m_journal) {
+        m_journal->record(parentNode->getId(), ChangeKind::Detach, NodeProperty::Hierarchy, childNode->getId(), PropertyValue());
+    }
 
     // DAG Handling:
-    // In a multi-parent scenario, nodes in the detached subtree might still be 
-    // reachable from the main tree root via other parents. We must NOT remove 
-    // those nodes from the lookup maps.
-    
-    std::unordered_set<SceneNode*> retainedNodes;
-
-    // 1. Identify "Entry Points": Nodes in the detached set that have parents 
-    //    still existing in the main tree (and not part of the detached set).
-    for (auto const& [id, node_ptr] : detachedTree->m_node_lookup) {
-        for (const auto& weakP : node_ptr->getParents()) {
-            if (auto p = weakP.lock()) {
-                // If parent is in main tree BUT NOT in detached tree
-                if (m_node_lookup.count(p->getId()) && 
-                    detachedTree->m_node_lookup.find(p->getId()) == detachedTree->m_node_lookup.end()) {
-                    retainedNodes.insert(node_ptr);
-                }
-            }
-        }
+    // Nodes in the detached subtree that are still referenced by a parent in this tree stay
+    // indexed here. The reference counts decide this locally, walking only released nodes.
+    std::vector<SceneNode*> released;
+    auto child_it = m_node_lookup.find(childNode->getId());
+    if (childNode != m_root.get() && child_it != m_node_lookup.end() &&
+        child_it->second.node == childNode && m_slot_refs[child_it->second.slot] == 0) {
+        released = collectReleased(childNode);
     }
+    std::unordered_set<const SceneNode*> releasedSet(released.begin(), released.end());
 
-    // 2. Propagate retention: If a node is retained, all its descendants must be retained.
-    std::vector<SceneNode*> queue(retainedNodes.begin(), retainedNodes.end());
-    size_t head = 0;
-    while(head < queue.size()){
-        SceneNode* curr = queue[head++];
-        for(auto& child : curr->getChildren()){
-            // If child is in detached tree (it must be) and not yet retained
-            if (detachedTree->m_node_lookup.count(child->getId())) {
-                if (retainedNodes.find(child.get()) == retainedNodes.end()) {
-                    retainedNodes.insert(child.get());
-                    queue.push_back(child.get());
-                }
-            }
-        }
+    // Released nodes can be cut out of the linear order in place; it is rebuilt if any node of
+    // the detached subtree stays behind, since its depth or parent may change
+    if (linearWasClean) {
+        m_linear_dirty = false;
     }
 
-    // 3. Erase only nodes that are NOT retained
-    for (auto const& [id, node_ptr] : detachedTree->m_node_lookup) {
-        if (retainedNodes.find(node_ptr) == retainedNodes.end()) {
-            m_node_lookup.erase(id);
-            
-            auto it = m_name_lookup.find(node_ptr->getName());
-            if (it != m_name_lookup.end()) {
-                auto& vec = it->second;
-                vec.erase(std::remove(vec.begin(), vec.end(), node_ptr), vec.end());
-                if (vec.empty()) {
-                    m_name_lookup.erase(it);
-                }
-            }
-
-            // Remove from tag lookup
-            for (const auto& tag : node_ptr->getTags()) {
-                auto tag_it = m_tag_lookup.find(tag);
-                if (tag_it != m_tag_lookup.end()) {
-                    auto& vec = tag_it->second;
-                    vec.erase(std::remove(vec.begin(), vec.end(), node_ptr), vec.end());
-                    if (vec.empty()) {
-                        m_tag_lookup.erase(tag_it);
-                    }
-                }
-            }
-
-            // Stop observing
-            node_ptr->unregisterObserver(m_node_observer.get());
+    // Build the detached tree in pre-order. Released nodes move their lookup entry and observer
+    // registration over; nodes that stay behind are indexed by both trees.
+    std::unique_ptr<SceneTree> detachedTree(new SceneTree(childSharedPtr, DeferIndexing{}));
+    size_t retained = 0;
+    for (SceneNode* node : childNode->preOrder()) {
+        if (releasedSet.count(node)) {
+            eraseNodeEntry(node->getId());
+            detachedTree->indexNode(node, m_node_observer.get());
+        } else {
+            detachedTree->indexNode(node);
+            ++retained;
         }
     }
-    
+
+    if (retained > 0) {
+        m_linear_dirty = true;
+    }
+    compactLinearOrder();
+
     return detachedTree;
 }
 
@@ -307,25 +484,207 @@ std::shared_ptr<SceneNode> SceneTree::getRoot() const {
 void SceneTree::print() const {
     if (!m_root) return;
 
-    auto print_recursive = [](const SceneNode& node, int depth, auto&& self) -> void {
-        std::string indent(depth * 4, ' ');
+    // Shared nodes are listed under every parent, but their subtree is expanded only once
+    std::unordered_set<const SceneNode*> expanded;
+    auto range = m_root->preOrder(VisitMode::AllPaths);
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        const SceneNode& node = **it;
+        std::string indent(it.depth() * 4, ' ');
         std::cout << indent << "- " << node.getName() << " (ID: " << node.getId() 
                   << ", Status: " << node.getStatus() 
-                  << ", Parents: " << node.getParents().size() << ")" << std::endl;
-        for (const auto& child : node.getChildren()) {
-            self(*child, depth + 1, self);
+                  << ", Parents: " << node.getParents().size() << ")";
+        if (node.getParents().size() > 1 && !expanded.insert(&node).second) {
+            std::cout << " [shared, see above]";
+            it.skipChildren();
+        }
+        std::cout << std::endl;
+    }
+}
+
+PreOrderRange SceneTree::preOrder(VisitMode mode) const {
+    return PreOrderRange(m_root.get(), mode);
+}
+
+PostOrderRange SceneTree::postOrder(VisitMode mode) const {
+    return PostOrderRange(m_root.get(), mode);
+}
+
+BreadthFirstRange SceneTree::breadthFirst(VisitMode mode) const {
+    return BreadthFirstRange(m_root.get(), mode);
+}
+
+namespace {
+// Work items shared by the calling thread and the executor tasks. Items are claimed through an
+// atomic cursor, so a task that only starts after everything is done returns without touching
+// any of the caller's data; the caller waits for claimed items only.
+struct ParallelWork {
+    explicit ParallelWork(size_t items) : itemCount(items) {}
+
+    template <typename ProcessItem>
+    void run(const ProcessItem& processItem) {
+        for (size_t i = next.fetch_add(1); i < itemCount; i = next.fetch_add(1)) {
+            if (!stopped.load(std::memory_order_relaxed)) {
+                try {
+                    processItem(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error) error = std::current_exception();
+                    stopped.store(true);
+                }
+            }
+            if (done.fetch_add(1) + 1 == itemCount) {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.notify_all();
+            }
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return done.load() == itemCount; });
+    }
+
+    const size_t itemCount;
+    std::atomic<size_t> next{0};
+    std::atomic<size_t> done{0};
+    std::atomic<bool> stopped{false};
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr error;
+};
+
+size_t parallelWorkerCount() {
+    unsigned int threads = std::thread::hardware_concurrency();
+    return threads > 1 ? threads : 2;
+}
+
+// Hands 'work' to up to workerCount - 1 executor tasks, helps on the calling thread and joins
+template <typename ProcessItem>
+void runParallel(task_engine::TaskExecutor& executor, const std::shared_ptr<ParallelWork>& work,
+                 const ProcessItem& processItem) {
+    size_t tasks = std::min(parallelWorkerCount(), work->itemCount);
+    for (size_t i = 1; i < tasks; ++i) {
+        executor.add_task(TASK_FROM_HERE, [work, processItem]() { work->run(processItem); });
+    }
+    work->run(processItem);
+    work->wait();
+    if (work->error) {
+        std::rethrow_exception(work->error);
+    }
+}
+}
+
+void SceneTree::parallelForEach(task_engine::TaskExecutor& executor, const NodeFunction& fn, size_t grainSize) {
+    if (m_slot_nodes.empty() || !fn) return;
+
+    // The dense node array holds every reachable node exactly once, so plain chunks are balanced
+    size_t grain = std::max<size_t>(grainSize, 1);
+    size_t count = m_slot_nodes.size();
+    auto work = std::make_shared<ParallelWork>((count + grain - 1) / grain);
+    SceneNode* const* nodes = m_slot_nodes.data();
+    auto processChunk = [nodes, count, grain, &fn](size_t chunk) {
+        size_t end = std::min(count, (chunk + 1) * grain);
+        for (size_t i = chunk * grain; i < end; ++i) {
+            fn(*nodes[i]);
         }
     };
 
-    print_recursive(*m_root, 0, print_recursive);
+    m_parallel_pass = true;
+    try {
+        runParallel(executor, work, processChunk);
+    } catch (...) {
+        m_parallel_pass = false;
+        throw;
+    }
+    m_parallel_pass = false;
 }
 
-void SceneTree::addPropertyListener(NodeProperty prop, PropertyListener listener) {
-    m_global_listeners[prop].push_back(std::move(listener));
+bool SceneTree::parallelVisit(task_engine::TaskExecutor& executor, const NodeVisitor& visitor) {
+    if (!m_root || !visitor) return true;
+
+    // A node with several parents may be reached by more than one task; the first to claim it
+    // visits it and its subtree.
+    std::unique_ptr<std::atomic<bool>[]> claimed(new std::atomic<bool>[m_slot_nodes.size()]());
+    auto claim = [this, &claimed](SceneNode* node) {
+        if (node->getParents().size() < 2) return true;
+        auto it = m_node_lookup.find(node->getId());
+        if (it == m_node_lookup.end() || it->second.node != node) return true;
+        return !claimed[it->second.slot].exchange(true);
+    };
+
+    // 1. Visit the top levels breadth-first on this thread until the frontier holds enough
+    //    subtrees to keep every worker busy
+    struct Item {
+        SceneNode* node;
+        size_t depth;
+    };
+    const size_t targetItems = parallelWorkerCount() * 8;
+    std::deque<Item> frontier{{m_root.get(), 0}};
+    while (!frontier.empty() && frontier.size() < targetItems) {
+        Item item = frontier.front();
+        frontier.pop_front();
+        if (!claim(item.node)) continue;
+        VisitResult result = visitor(*item.node, item.depth);
+        if (result == VisitResult::Stop) return false;
+        if (result == VisitResult::SkipChildren) continue;
+        for (const auto& child : item.node->getChildren()) {
+            if (child) frontier.push_back({child.get(), item.depth + 1});
+        }
+    }
+    if (frontier.empty()) return true;
+
+    // 2. Each remaining subtree is one task, traversed pre-order with an explicit stack
+    std::vector<Item> items(frontier.begin(), frontier.end());
+    auto work = std::make_shared<ParallelWork>(items.size());
+    ParallelWork* state = work.get();
+    auto processSubtree = [&items, &claim, &visitor, state](size_t index) {
+        std::vector<Item> stack{items[index]};
+        while (!stack.empty() && !state->stopped.load(std::memory_order_relaxed)) {
+            Item item = stack.back();
+            stack.pop_back();
+            if (!claim(item.node)) continue;
+            VisitResult result = visitor(*item.node, item.depth);
+            if (result == VisitResult::Stop) {
+                state->stopped.store(true);
+                return;
+            }
+            if (result == VisitResult::SkipChildren) continue;
+            const auto& children = item.node->getChildren();
+            for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                if (*it) stack.push_back({it->get(), item.depth + 1});
+            }
+        }
+    };
+
+    m_parallel_pass = true;
+    try {
+        runParallel(executor, work, processSubtree);
+    } catch (...) {
+        m_parallel_pass = false;
+        throw;
+    }
+    m_parallel_pass = false;
+    return !work->stopped.load();
+}
+
+ListenerHandle SceneTree::addPropertyListener(NodeProperty prop, PropertyListener listener) {
+    return m_listeners->add(prop, std::move(listener));
+}
+
+ListenerHandle SceneTree::addNodePropertyListener(ObjectId id, NodeProperty prop, PropertyListener listener) {
+    return m_listeners->add(id, prop, std::move(listener));
+}
+
+bool SceneTree::removePropertyListener(ListenerHandle handle) {
+    return m_listeners->remove(handle);
+}
+
+PropertySubscription SceneTree::subscribe(NodeProperty prop, PropertyListener listener) {
+    return PropertySubscription(m_listeners, m_listeners->add(prop, std::move(listener)));
 }
 
-void SceneTree::addNodePropertyListener(ObjectId id, NodeProperty prop, PropertyListener listener) {
-    m_node_listeners[prop][id].push_back(std::move(listener));
+PropertySubscription SceneTree::subscribe(ObjectId id, NodeProperty prop, PropertyListener listener) {
+    return PropertySubscription(m_listeners, m_listeners->add(id, prop, std::move(listener)));
 }
 
 void SceneTree::setBatchingEnabled(bool enabled) {
@@ -335,6 +694,224 @@ void SceneTree::setBatchingEnabled(bool enabled) {
     }
 }
 
+SceneTree::EditScope SceneTree::beginEdit() {
+    ++m_edit_depth;
+    return EditScope(this);
+}
+
+bool SceneTree::isEditing() const {
+    return m_edit_depth > 0;
+}
+
+void SceneTree::EditScope::commit() {
+    if (!m_tree) return;
+    SceneTree* tree = m_tree;
+    m_tree = nullptr;
+    tree->endEdit();
+}
+
+void SceneTree::endEdit() {
+    if (m_edit_depth == 0 || --m_edit_depth > 0) return;
+
+    flushEdit();
+
+    // Listeners run outside the edit, so whatever they change is applied right away
+    std::vector<PendingEvent> notices;
+    notices.swap(m_edit_notices);
+    for (const auto& notice : notices) {
+        if (auto node = notice.node.lock(); node && containsNode(node.get())) {
+            publishChange(node.get(), notice.prop, notice.oldVal, notice.newVal);
+        }
+    }
+}
+
+namespace {
+// Key for coalescing the events recorded during an edit per (node, value)
+template <typename Value>
+struct EditKey {
+    SceneNode* node;
+    Value value;
+    bool operator==(const EditKey& other) const { return node == other.node && value == other.value; }
+};
+
+template <typename Value>
+struct EditKeyHash {
+    size_t operator()(const EditKey<Value>& key) const {
+        return std::hash<const void*>{}(key.node) * 31 + std::hash<Value>{}(key.value);
+    }
+};
+
+// Net effect of the recorded events for one key, in order of first occurrence
+template <typename Value>
+struct NetChanges {
+    struct Change {
+        std::shared_ptr<SceneNode> node;
+        Value value;
+        int net;
+    };
+
+    void add(std::shared_ptr<SceneNode> node, Value value, int delta) {
+        auto [it, inserted] = index.try_emplace(EditKey<Value>{node.get(), value}, changes.size());
+        if (inserted) {
+            changes.push_back({std::move(node), value, delta});
+        } else {
+            changes[it->second].net += delta;
+        }
+    }
+
+    std::unordered_map<EditKey<Value>, size_t, EditKeyHash<Value>> index;
+    std::vector<Change> changes;
+};
+}
+
+// Applies everything recorded since beginEdit() to the indexes and queues the coalesced
+// notifications for endEdit().
+void SceneTree::flushEdit() {
+    // 1. Coalesce the queued events
+    std::vector<PendingEvent> events(m_event_queue.begin() + m_event_head, m_event_queue.end());
+    m_event_queue.clear();
+    m_event_head = 0;
+    NetChanges<StringAtom> tagChanges;
+    NetChanges<ObjectId> linkChanges;
+    std::vector<PendingEvent> otherEvents;
+    for (auto& event : events) {
+        auto node = event.node.lock();
+        if (!node || !containsNode(node.get())) continue;
+        switch (event.prop) {
+            case NodeProperty::TagAdded:
+                tagChanges.add(node, event.newVal.get<StringAtom>(), 1);
+                break;
+            case NodeProperty::TagRemoved:
+                tagChanges.add(node, event.oldVal.get<StringAtom>(), -1);
+                break;
+            case NodeProperty::Hierarchy:
+                if (event.newVal.has_value()) {
+                    linkChanges.add(node, event.newVal.get<ObjectId>(), 1);
+                } else {
+                    linkChanges.add(node, event.oldVal.get<ObjectId>(), -1);
+                }
+                break;
+            default:
+                otherEvents.push_back(std::move(event));
+                break;
+        }
+    }
+
+    for (const auto& change : linkChanges.changes) {
+        if (change.net > 0) {
+            m_edit_notices.push_back({change.node, NodeProperty::Hierarchy, PropertyValue(), change.value});
+        } else if (change.net < 0) {
+            m_edit_notices.push_back({change.node, NodeProperty::Hierarchy, change.value, PropertyValue()});
+        }
+    }
+
+    // 2. Names and statuses of dirty nodes
+    std::vector<std::weak_ptr<SceneNode>> dirty(m_dirty_nodes.begin() + m_dirty_head, m_dirty_nodes.end());
+    m_dirty_nodes.clear();
+    m_dirty_head = 0;
+    for (auto& weak_node : dirty) {
+        auto node = weak_node.lock();
+        if (!node || !containsNode(node.get())) continue;
+        if (node->arePropertiesDirty(NodeProperty::Name) && node->getCleanNameAtom() != node->getNameAtom()) {
+            uint32_t slot = m_node_lookup.find(node->getId())->second.slot;
+            removeFromNameBucket(slot);
+            addToNameBucket(slot, node->getNameAtom());
+            m_edit_notices.push_back({node, NodeProperty::Name, node->getCleanNameAtom(), node->getNameAtom()});
+        }
+        if (node->arePropertiesDirty(NodeProperty::Status) && node->getCleanStatus() != node->getStatus()) {
+            m_edit_notices.push_back({node, NodeProperty::Status, node->getCleanStatus(), node->getStatus()});
+            markEffectiveDirty(node->getId());
+        }
+        if (node->arePropertiesDirty(NodeProperty::Visibility) && node->getCleanVisible() != node->isVisible()) {
+            m_edit_notices.push_back({node, NodeProperty::Visibility, PropertyValue(node->getCleanVisible()),
+                                      PropertyValue(node->isVisible())});
+            markEffectiveDirty(node->getId());
+        }
+        node->clearDirty();
+    }
+
+    // 3. Net tag changes
+    for (const auto& change : tagChanges.changes) {
+        if (change.net == 0) continue; // Added and removed again
+        SceneNode* node = change.node.get();
+        uint32_t slot = m_node_lookup.find(node->getId())->second.slot;
+        if (change.net > 0) {
+            addToTagBucket(slot, change.value);
+            uint32_t bit = m_tag_registry.registerTag(change.value);
+            if (bit != TagRegistry::kNoBit) m_slot_tags[slot].set(bit);
+            m_edit_notices.push_back({change.node, NodeProperty::TagAdded, PropertyValue(), change.value});
+        } else {
+            removeFromTagBucket(slot, change.value);
+            uint32_t bit = m_tag_registry.bitFor(change.value);
+            if (bit != TagRegistry::kNoBit) m_slot_tags[slot].reset(bit);
+            m_edit_notices.push_back({change.node, NodeProperty::TagRemoved, change.value, PropertyValue()});
+        }
+    }
+
+    m_edit_notices.insert(m_edit_notices.end(), std::make_move_iterator(otherEvents.begin()),
+                          std::make_move_iterator(otherEvents.end()));
+
+    // 4. Release the nodes that are still cut off from every in-tree parent
+    std::vector<std::shared_ptr<SceneNode>> candidates;
+    candidates.swap(m_edit_released);
+    std::vector<SceneNode*> released;
+    for (const auto& candidate : candidates) {
+        auto it = m_node_lookup.find(candidate->getId());
+        if (candidate == m_root || it == m_node_lookup.end() || it->second.node != candidate.get() ||
+            m_slot_refs[it->second.slot] != 0) {
+            continue;
+        }
+        std::vector<SceneNode*> part = collectReleased(candidate.get());
+        released.insert(released.end(), part.begin(), part.end());
+    }
+    // A candidate may also have been reached through another one; erase each node once
+    std::sort(released.begin(), released.end());
+    released.erase(std::unique(released.begin(), released.end()), released.end());
+    for (SceneNode* releasedNode : released) {
+        eraseNodeEntry(releasedNode->getId());
+        releasedNode->unregisterObserver(m_node_observer.get());
+    }
+    candidates.clear();
+
+    // 5. Index the attached subtrees that are still linked below an indexed node. Their nodes
+    //    were not observed during the edit, so indexing reads their final state.
+    std::vector<std::shared_ptr<SceneNode>> roots;
+    roots.swap(m_edit_roots);
+    m_edit_pending.clear();
+    size_t firstNew = m_slot_nodes.size();
+    for (const auto& root : roots) {
+        if (containsNode(root.get())) continue;
+        const auto& parents = root->getParents();
+        bool linked = std::any_of(parents.begin(), parents.end(), [this](const std::weak_ptr<SceneNode>& weakParent) {
+            auto parent = weakParent.lock();
+            return parent && containsNode(parent.get());
+        });
+        if (linked) buildNodeMap(root);
+    }
+    for (size_t slot = firstNew; slot < m_slot_nodes.size(); ++slot) {
+        m_slot_nodes[slot]->clearDirty();
+    }
+}
+
+void SceneTree::enableChangeJournal(size_t capacity) {
+    m_journal = capacity > 0 ? std::make_shared<ChangeJournal>(capacity) : nullptr;
+}
+
+std::shared_ptr<const ChangeJournal> SceneTree::getChangeJournal() const {
+    return m_journal;
+}
+
+// Every applied change leaves the tree through here: journal first, then listeners
+void SceneTree::publishChange(SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal) {
+    if (m_journal) {
+        m_journal->record(node->getId(), ChangeKind::Property, prop, oldVal, newVal);
+    }
+    if (!m_live_queries.empty()) {
+        noteLiveQueryChange(node, prop, oldVal, newVal);
+    }
+    m_listeners->dispatch(node, prop, oldVal, newVal);
+}
+
 void SceneTree::update(double deltaTime) {
     // Currently, we just process pending property changes.
     // In the future, this is where we would update animations, spatial partitions, etc.
@@ -342,28 +919,52 @@ void SceneTree::update(double deltaTime) {
 }
 
 void SceneTree::processEvents() {
-    // 1. Process Dirty Nodes (Batched Updates)
-    if (!m_dirty_nodes.empty()) {
-        std::vector<std::weak_ptr<SceneNode>> nodes;
-        nodes.swap(m_dirty_nodes);
-
-        for (auto& weak_node : nodes) {
-            if (auto node = weak_node.lock()) {
-                if (m_node_lookup.count(node->getId())) {
-                    resolveDirtyNode(node.get());
-                }
+    processEvents(EventBudget{});
+}
+
+size_t SceneTree::processEvents(const EventBudget& budget) {
+    if (m_edit_depth > 0) return 0; // Everything is applied at commit
+
+    // Both queues are consumed from a cursor, so an exhausted budget leaves the rest in order for
+    // the next call, and a drained queue is cleared in place without giving up its capacity.
+    // Items queued while processing (by listeners) wait for the next call. A nested call from a
+    // listener shares the cursors and so never handles an item twice.
+    using Clock = std::chrono::steady_clock;
+    const bool timed = budget.maxTime.count() > 0;
+    const Clock::time_point deadline = timed ? Clock::now() + budget.maxTime : Clock::time_point();
+    size_t processed = 0;
+    auto exhausted = [&]() {
+        if (budget.maxEvents > 0 && processed >= budget.maxEvents) return true;
+        // Reading the clock is cheap but not free; check it every few items
+        return timed && (processed % 8) == 0 && processed > 0 && Clock::now() >= deadline;
+    };
+    ++m_processing_depth;
+
+    // The two queues are served alternately, one item at a time, so that a steady stream of
+    // dirty nodes cannot starve queued events (tags, hierarchy) under a budget, or vice versa.
+    // Whose turn it is carries over to the next call.
+    const size_t dirtyEnd = m_dirty_nodes.size();
+    const size_t eventEnd = m_event_queue.size();
+    while (!exhausted()) {
+        const bool dirtyLeft = m_dirty_head < std::min(dirtyEnd, m_dirty_nodes.size());
+        const bool eventsLeft = m_event_head < std::min(eventEnd, m_event_queue.size());
+        if (!dirtyLeft && !eventsLeft) break;
+        const bool takeEvent = eventsLeft && (m_events_turn || !dirtyLeft);
+        m_events_turn = !takeEvent;
+        ++processed;
+
+        if (!takeEvent) {
+            // Dirty node (batched name/status/visibility updates)
+            auto node = m_dirty_nodes[m_dirty_head++].lock();
+            if (node && m_node_lookup.count(node->getId())) {
+                resolveDirtyNode(node.get());
             }
+            continue;
         }
-    }
 
-    // 2. Process Event Queue (Immediate/Non-batched events like Tags)
-    if (m_event_queue.empty()) return;
-
-    // Swap queue to allow new events to be added safely during processing
-    std::vector<PendingEvent> processing_queue;
-    processing_queue.swap(m_event_queue);
-
-    for (const auto& event : processing_queue) {
+        // Queued event (immediate/non-batched events like tags). Copied out: a listener may
+        // queue events and so reallocate the queue
+        PendingEvent event = m_event_queue[m_event_head++];
         if (auto node_ptr = event.node.lock()) {
             // Ensure the node is still part of this tree before processing
             if (m_node_lookup.find(node_ptr->getId()) != m_node_lookup.end()) {
@@ -371,39 +972,53 @@ void SceneTree::processEvents() {
             }
         }
     }
+
+    if (--m_processing_depth == 0) {
+        compactQueue(m_dirty_nodes, m_dirty_head);
+        compactQueue(m_event_queue, m_event_head);
+    }
+    return processed;
+}
+
+size_t SceneTree::pendingEventCount() const {
+    return (m_dirty_nodes.size() - m_dirty_head) + (m_event_queue.size() - m_event_head);
+}
+
+// Drops the consumed front of a queue. A fully consumed queue is cleared; a partly consumed one
+// is shifted once the consumed part is at least half of it, which keeps shifting amortized O(1).
+template <typename Item>
+void SceneTree::compactQueue(std::vector<Item>& queue, size_t& head) {
+    if (head == queue.size()) {
+        queue.clear();
+        head = 0;
+    } else if (head > 0 && head * 2 >= queue.size()) {
+        queue.erase(queue.begin(), queue.begin() + head);
+        head = 0;
+    }
 }
 
 void SceneTree::resolveDirtyNode(SceneNode* node) {
     // Optimization: Check if any relevant properties are dirty using the bitmask.
     // This avoids individual checks if the node is dirty due to unhandled properties.
-    if (!node->arePropertiesDirty(NodeProperty::Name | NodeProperty::Status)) {
+    if (!node->arePropertiesDirty(NodeProperty::Name | NodeProperty::Status | NodeProperty::Visibility)) {
         node->clearDirty();
         return;
     }
 
     // Handle Name Changes
     if (node->arePropertiesDirty(NodeProperty::Name)) {
-        std::string oldName = node->getCleanName();
-        std::string newName = node->getName();
+        StringAtom oldName = node->getCleanNameAtom();
+        StringAtom newName = node->getNameAtom();
         
         // Update Index
-        auto it = m_name_lookup.find(oldName);
-        if (it != m_name_lookup.end()) {
-            auto& vec = it->second;
-            vec.erase(std::remove(vec.begin(), vec.end(), node), vec.end());
-            if (vec.empty()) m_name_lookup.erase(it);
+        auto entry_it = m_node_lookup.find(node->getId());
+        if (entry_it != m_node_lookup.end() && entry_it->second.node == node) {
+            removeFromNameBucket(entry_it->second.slot);
+            addToNameBucket(entry_it->second.slot, newName);
         }
-        m_name_lookup[newName].push_back(node);
 
         // Notify Listeners
-        if (auto it = m_global_listeners.find(NodeProperty::Name); it != m_global_listeners.end()) {
-            for (auto& listener : it->second) listener(node, NodeProperty::Name, oldName, newName);
-        }
-        if (auto it = m_node_listeners.find(NodeProperty::Name); it != m_node_listeners.end()) {
-            if (auto node_it = it->second.find(node->getId()); node_it != it->second.end()) {
-                for (auto& listener : node_it->second) listener(node, NodeProperty::Name, oldName, newName);
-            }
-        }
+        publishChange(node, NodeProperty::Name, oldName, newName);
     }
 
     // Handle Status Changes
@@ -411,97 +1026,864 @@ void SceneTree::resolveDirtyNode(SceneNode* node) {
         ObjectStatus oldStatus = node->getCleanStatus();
         ObjectStatus newStatus = node->getStatus();
 
+        markEffectiveDirty(node->getId());
         // Notify Listeners
-        if (auto it = m_global_listeners.find(NodeProperty::Status); it != m_global_listeners.end()) {
-            for (auto& listener : it->second) listener(node, NodeProperty::Status, oldStatus, newStatus);
-        }
-        if (auto it = m_node_listeners.find(NodeProperty::Status); it != m_node_listeners.end()) {
-            if (auto node_it = it->second.find(node->getId()); node_it != it->second.end()) {
-                for (auto& listener : node_it->second) listener(node, NodeProperty::Status, oldStatus, newStatus);
-            }
-        }
+        publishChange(node, NodeProperty::Status, oldStatus, newStatus);
+    }
+
+    // Handle Visibility Changes
+    if (node->arePropertiesDirty(NodeProperty::Visibility)) {
+        bool oldVisible = node->getCleanVisible();
+        bool newVisible = node->isVisible();
+
+        markEffectiveDirty(node->getId());
+        // Notify Listeners
+        publishChange(node, NodeProperty::Visibility, PropertyValue(oldVisible), PropertyValue(newVisible));
     }
 
     node->clearDirty();
 }
 
-void SceneTree::handlePropertyChange(SceneNode* node, NodeProperty prop, const std::any& oldVal, const std::any& newVal) {
+void SceneTree::handlePropertyChange(SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal) {
     // 1. Update internal indices
     switch (prop) {
         // Name is now handled via Dirty Flag system in resolveDirtyNode
         case NodeProperty::TagAdded: {
-            std::string tag = std::any_cast<std::string>(newVal);
-            m_tag_lookup[tag].push_back(node);
+            StringAtom tag = newVal.get<StringAtom>();
+            uint32_t bit = m_tag_registry.registerTag(tag);
+            if (auto entry_it = m_node_lookup.find(node->getId()); entry_it != m_node_lookup.end()) {
+                addToTagBucket(entry_it->second.slot, tag);
+                if (bit != TagRegistry::kNoBit) m_slot_tags[entry_it->second.slot].set(bit);
+            }
             break;
         }
         case NodeProperty::TagRemoved: {
-            std::string tag = std::any_cast<std::string>(oldVal);
-            auto it = m_tag_lookup.find(tag);
-            if (it != m_tag_lookup.end()) {
-                auto& vec = it->second;
-                vec.erase(std::remove(vec.begin(), vec.end(), node), vec.end());
-                if (vec.empty()) m_tag_lookup.erase(it);
+            StringAtom tag = oldVal.get<StringAtom>();
+            uint32_t bit = m_tag_registry.bitFor(tag);
+            if (auto entry_it = m_node_lookup.find(node->getId()); entry_it != m_node_lookup.end()) {
+                removeFromTagBucket(entry_it->second.slot, tag);
+                if (bit != TagRegistry::kNoBit) m_slot_tags[entry_it->second.slot].reset(bit);
             }
             break;
         }
         default: break;
     }
 
-    // 2. Notify global listeners
-    if (auto it = m_global_listeners.find(prop); it != m_global_listeners.end()) {
-        for (auto& listener : it->second) listener(node, prop, oldVal, newVal);
+    // 2. Notify listeners
+    publishChange(node, prop, oldVal, newVal);
+}
+
+void SceneTree::buildNodeMap(const std::shared_ptr<SceneNode>& node) {
+    if (!node) return;
+
+    auto range = node->preOrder();
+    for (auto it = range.begin(); it != range.end(); ++it) {
+        SceneNode* current = *it;
+        if (containsNode(current)) {
+            it.skipChildren(); // Shared subtree already indexed through another parent
+            continue;
+        }
+        indexNode(current);
+    }
+}
+
+// Adds one node to every index. 'previousObserver' is the observer of the tree the node moves
+// over from, which this tree's observer replaces in place.
+void SceneTree::indexNode(SceneNode* node, INodeObserver* previousObserver) {
+    uint32_t slot = insertNodeEntry(node);
+    // An ID overwrite leaves the previous node's entries behind. Re-adding makes the node the
+    // newest entry of its buckets, so a re-indexed node moves to the back of the "first" order.
+    removeFromBuckets(slot);
+    addToNameBucket(slot, node->getNameAtom());
+    for (const auto& tag : node->getTags()) addToTagBucket(slot, tag);
+
+    if (previousObserver) {
+        std::replace(node->m_observers.begin(), node->m_observers.end(), previousObserver, m_node_observer.get());
+    } else {
+        node->registerObserver(m_node_observer.get());
+    }
+
+    // In-tree parent edges: those from parents indexed earlier, and from this node to
+    // children that were indexed before it
+    uint32_t refs = 0;
+    for (const auto& weakParent : node->getParents()) {
+        if (auto parent = weakParent.lock(); parent && containsNode(parent.get())) ++refs;
     }
+    m_slot_refs[slot] = refs;
+    for (const auto& child : node->getChildren()) {
+        if (!child) continue;
+        auto it = m_node_lookup.find(child->getId());
+        if (it != m_node_lookup.end() && it->second.node == child.get()) ++m_slot_refs[it->second.slot];
+    }
+}
 
-    // 3. Notify node-specific listeners
-    if (auto it = m_node_listeners.find(prop); it != m_node_listeners.end()) {
-        if (auto node_it = it->second.find(node->getId()); node_it != it->second.end()) {
-            for (auto& listener : node_it->second) listener(node, prop, oldVal, newVal);
+// Starting from a node whose last in-tree parent edge was just cut, collects every node that is
+// no longer reachable. Each released node drops one reference from each of its children, so
+// only the released region is visited and nodes still held by another parent stay.
+std::vector<SceneNode*> SceneTree::collectReleased(SceneNode* start) {
+    std::vector<SceneNode*> released{start};
+    for (size_t i = 0; i < released.size(); ++i) {
+        for (const auto& child : released[i]->getChildren()) {
+            if (!child || child.get() == m_root.get()) continue;
+            auto it = m_node_lookup.find(child->getId());
+            if (it == m_node_lookup.end() || it->second.node != child.get()) continue;
+            uint32_t& refs = m_slot_refs[it->second.slot];
+            if (refs > 0 && --refs == 0) released.push_back(child.get());
         }
     }
+    return released;
 }
 
-void SceneTree::buildNodeMap(const std::shared_ptr<SceneNode>& node) {
-    if (!node) return;
-    m_node_lookup[node->getId()] = node.get();
-    m_name_lookup[node->getName()].push_back(node.get());
+void SceneTree::addToNameBucket(uint32_t slot, StringAtom name) {
+    m_slot_name[slot] = {name, m_name_lookup[name].insert(m_slot_nodes[slot], slot)};
+}
 
-    for (const auto& tag : node->getTags()) m_tag_lookup[tag].push_back(node.get());
-    
-    node->registerObserver(m_node_observer.get());
+void SceneTree::removeFromNameBucket(uint32_t slot) {
+    BucketRef ref = m_slot_name[slot];
+    if (ref.position == NodeBucket::kNone) return;
+    m_slot_name[slot].position = NodeBucket::kNone;
+    auto it = m_name_lookup.find(ref.key);
+    uint32_t moved = it->second.erase(ref.position);
+    if (moved != NodeBucket::kNone) m_slot_name[moved].position = ref.position;
+    if (it->second.empty()) m_name_lookup.erase(it);
+}
 
-    for (const auto& child : node->getChildren()) {
-        buildNodeMap(child);
+void SceneTree::addToTagBucket(uint32_t slot, StringAtom tag) {
+    auto& refs = m_slot_tag_refs[slot];
+    for (const BucketRef& ref : refs) {
+        if (ref.key == tag) return; // Already indexed, e.g. by attach() before the event was processed
     }
+    refs.push_back({tag, m_tag_lookup[tag].insert(m_slot_nodes[slot], slot)});
 }
 
-void SceneTree::removeNodeMap(const std::shared_ptr<SceneNode>& node) {
-    if (!node) return;
-    m_node_lookup.erase(node->getId());
-    
-    auto it = m_name_lookup.find(node->getName());
-    if (it != m_name_lookup.end()) {
-        auto& vec = it->second;
-        vec.erase(std::remove(vec.begin(), vec.end(), node.get()), vec.end());
-        if (vec.empty()) {
-            m_name_lookup.erase(it);
+void SceneTree::removeFromTagBucket(uint32_t slot, StringAtom tag) {
+    auto& refs = m_slot_tag_refs[slot];
+    auto ref_it = std::find_if(refs.begin(), refs.end(), [tag](const BucketRef& ref) { return ref.key == tag; });
+    if (ref_it == refs.end()) return;
+    uint32_t position = ref_it->position;
+    *ref_it = refs.back();
+    refs.pop_back();
+
+    auto it = m_tag_lookup.find(tag);
+    uint32_t moved = it->second.erase(position);
+    if (moved != NodeBucket::kNone) {
+        for (BucketRef& movedRef : m_slot_tag_refs[moved]) {
+            if (movedRef.key == tag) movedRef.position = position;
         }
     }
+    if (it->second.empty()) m_tag_lookup.erase(it);
+}
+
+void SceneTree::removeFromBuckets(uint32_t slot) {
+    removeFromNameBucket(slot);
+    while (!m_slot_tag_refs[slot].empty()) {
+        removeFromTagBucket(slot, m_slot_tag_refs[slot].back().key);
+    }
+}
+
+// The node in slot 'from' now lives in slot 'to'; repoints its bucket entries
+void SceneTree::moveBucketEntries(uint32_t from, uint32_t to) {
+    m_slot_name[to] = m_slot_name[from];
+    m_slot_tag_refs[to] = std::move(m_slot_tag_refs[from]);
+    if (m_slot_name[to].position != NodeBucket::kNone) {
+        m_name_lookup.find(m_slot_name[to].key)->second.setOwner(m_slot_name[to].position, to);
+    }
+    for (const BucketRef& ref : m_slot_tag_refs[to]) {
+        m_tag_lookup.find(ref.key)->second.setOwner(ref.position, to);
+    }
+}
+
+void SceneTree::onChildLinked(ObjectId childId) {
+    auto it = m_node_lookup.find(childId);
+    if (it == m_node_lookup.end()) return; // Counted when attach() indexes it
+    ++m_slot_refs[it->second.slot];
+    markEffectiveDirty(childId);
+}
+
+void SceneTree::onChildUnlinked(ObjectId childId) {
+    auto it = m_node_lookup.find(childId);
+    if (it == m_node_lookup.end()) return;
+    markEffectiveDirty(childId);
+    uint32_t& refs = m_slot_refs[it->second.slot];
+    if (refs == 0 || --refs > 0 || m_detaching) return; // detach() releases on its own
+    SceneNode* node = it->second.node;
+    if (node == m_root.get()) return;
+
+    if (m_edit_depth > 0) {
+        // The node may be linked again before the edit ends; commit decides
+        m_edit_released.push_back(node->shared_from_this());
+        return;
+    }
+
+    // Cut off by a direct removeChild: drop the unreachable part from the indexes
+    std::vector<SceneNode*> released = collectReleased(node);
+    for (SceneNode* releasedNode : released) {
+        eraseNodeEntry(releasedNode->getId());
+        releasedNode->unregisterObserver(m_node_observer.get());
+    }
+}
+
+// Sizes the lookup and the per-slot arrays for 'nodeCount' nodes, so indexing a loaded or
+// attached tree does not rehash or regrow them on the way
+void SceneTree::reserveIndexes(size_t nodeCount) {
+    m_node_lookup.reserve(nodeCount);
+    m_slot_nodes.reserve(nodeCount);
+    m_slot_tags.reserve(nodeCount);
+    m_slot_refs.reserve(nodeCount);
+    m_slot_name.reserve(nodeCount);
+    m_slot_tag_refs.reserve(nodeCount);
+    m_slot_linear.reserve(nodeCount);
+    m_slot_effective.reserve(nodeCount);
+}
 
-    // Remove tags from index
+uint32_t SceneTree::insertNodeEntry(SceneNode* node) {
+    m_reach_dirty = true;
+    TagMask mask;
     for (const auto& tag : node->getTags()) {
-        auto tag_it = m_tag_lookup.find(tag);
-        if (tag_it != m_tag_lookup.end()) {
-            auto& vec = tag_it->second;
-            vec.erase(std::remove(vec.begin(), vec.end(), node.get()), vec.end());
-            if (vec.empty()) {
-                m_tag_lookup.erase(tag_it);
+        uint32_t bit = m_tag_registry.registerTag(tag);
+        if (bit != TagRegistry::kNoBit) mask.set(bit);
+    }
+
+    NodeEntry entry{node, static_cast<uint32_t>(m_slot_nodes.size())};
+    auto [it, inserted] = m_node_lookup.try_emplace(node->getId(), entry);
+    if (inserted) {
+        m_slot_nodes.push_back(node);
+        m_slot_tags.push_back(mask);
+        m_slot_linear.push_back(kNoSlot); // Placed by appendLinearOrder or the next rebuild
+        m_slot_refs.push_back(0);
+        m_slot_name.emplace_back();
+        m_slot_tag_refs.emplace_back();
+        m_slot_effective.push_back(kEffectiveUnknown | kEffectiveQueued);
+        m_effective_pending.push_back(node->getId());
+        if (!m_live_queries.empty() && !m_query_rescan) m_query_pending.push_back(node->getId());
+    } else {
+        // Already indexed (shared node reached through another parent, or an ID overwrite)
+        if (it->second.node != node) m_linear_dirty = true;
+        it->second.node = node;
+        m_slot_nodes[it->second.slot] = node;
+        m_slot_tags[it->second.slot] = mask;
+        markEffectiveDirty(node->getId());
+        if (!m_live_queries.empty() && !m_query_rescan) m_query_pending.push_back(node->getId());
+    }
+    return it->second.slot;
+}
+
+bool SceneTree::eraseNodeEntry(ObjectId id) {
+    auto it = m_node_lookup.find(id);
+    if (it == m_node_lookup.end()) return false;
+
+    m_reach_dirty = true;
+    // A node that leaves the tree takes its node-specific listeners with it
+    m_listeners->removeNode(id);
+    // Children that stay lose an in-tree parent; the ones leaving too are skipped when the
+    // pending set is drained
+    for (const auto& child : it->second.node->getChildren()) {
+        m_effective_pending.push_back(child->getId());
+    }
+    // Live queries must not keep a pointer to a node that left
+    for (const auto& weakQuery : m_live_queries) {
+        if (auto query = weakQuery.lock()) query->setMember(it->second.node, false);
+    }
+
+    uint32_t slot = it->second.slot;
+    removeFromBuckets(slot);
+
+    // Leave a hole in the linear order; compactLinearOrder() closes it
+    if (!m_linear_dirty && m_slot_linear[slot] != kNoSlot) {
+        m_linear_order[m_slot_linear[slot]].node = nullptr;
+    }
+
+    // Swap-remove keeps the dense arrays contiguous
+    uint32_t last = static_cast<uint32_t>(m_slot_nodes.size() - 1);
+    if (slot != last) {
+        SceneNode* moved = m_slot_nodes[last];
+        m_slot_nodes[slot] = moved;
+        m_slot_tags[slot] = m_slot_tags[last];
+        m_slot_refs[slot] = m_slot_refs[last];
+        moveBucketEntries(last, slot);
+        m_slot_linear[slot] = m_slot_linear[last];
+        m_slot_effective[slot] = m_slot_effective[last];
+        if (!m_linear_dirty && m_slot_linear[slot] != kNoSlot) {
+            m_linear_slots[m_slot_linear[slot]] = slot;
+        }
+        m_node_lookup.find(moved->getId())->second.slot = slot;
+    }
+    m_slot_nodes.pop_back();
+    m_slot_tags.pop_back();
+    m_slot_refs.pop_back();
+    m_slot_name.pop_back();
+    m_slot_tag_refs.pop_back();
+    m_slot_linear.pop_back();
+    m_slot_effective.pop_back();
+    m_node_lookup.erase(it);
+    return true;
+}
+
+TagMask SceneTree::getTagMask(const SceneNode* node) const {
+    auto it = m_node_lookup.find(node->getId());
+    if (it == m_node_lookup.end() || it->second.node != node) {
+        return TagMask();
+    }
+    return m_slot_tags[it->second.slot];
+}
+
+const TagRegistry& SceneTree::getTagRegistry() const {
+    return m_tag_registry;
+}
+
+TagQuery SceneTree::makeTagQuery(const std::vector<std::string>& include, const std::vector<std::string>& exclude) const {
+    std::vector<StringAtom> includeAtoms;
+    std::vector<StringAtom> excludeAtoms;
+    includeAtoms.reserve(include.size());
+    excludeAtoms.reserve(exclude.size());
+    for (const auto& tag : include) includeAtoms.push_back(StringAtom::find(tag));
+    for (const auto& tag : exclude) excludeAtoms.push_back(StringAtom::find(tag));
+    return makeTagQuery(includeAtoms, excludeAtoms);
+}
+
+TagQuery SceneTree::makeTagQuery(std::initializer_list<const char*> include, std::initializer_list<const char*> exclude) const {
+    return makeTagQuery(std::vector<std::string>(include.begin(), include.end()),
+                        std::vector<std::string>(exclude.begin(), exclude.end()));
+}
+
+TagQuery SceneTree::makeTagQuery(const std::vector<StringAtom>& include, const std::vector<StringAtom>& exclude) const {
+    TagQuery query;
+    for (const auto& tag : include) {
+        if (!tag.isValid() || !m_tag_registry.isRegistered(tag)) {
+            query.unsatisfiable = true; // No node in this tree has ever carried the tag
+            continue;
+        }
+        uint32_t bit = m_tag_registry.bitFor(tag);
+        if (bit != TagRegistry::kNoBit) {
+            query.include.set(bit);
+        } else {
+            query.overflowInclude.push_back(tag);
+        }
+    }
+    for (const auto& tag : exclude) {
+        if (!tag.isValid() || !m_tag_registry.isRegistered(tag)) {
+            continue; // Excluding an unknown tag excludes nothing
+        }
+        uint32_t bit = m_tag_registry.bitFor(tag);
+        if (bit != TagRegistry::kNoBit) {
+            query.exclude.set(bit);
+        } else {
+            query.overflowExclude.push_back(tag);
+        }
+    }
+    return query;
+}
+
+// Calls onMatch(slot) for every mask that has all 'include' bits and none of the 'exclude' bits.
+template <typename OnMatch>
+static void scanTagMasks(const TagMask* masks, size_t count, const TagMask& include, const TagMask& exclude,
+                         OnMatch&& onMatch) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    // Two masks per iteration
+    const __m256i inc = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(&include)));
+    const __m256i exc = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(&exclude)));
+    const __m256i zero = _mm256_setzero_si256();
+    for (; i + 2 <= count; i += 2) {
+        __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i));
+        __m256i hasAll = _mm256_cmpeq_epi64(_mm256_and_si256(m, inc), inc);
+        __m256i hasNone = _mm256_cmpeq_epi64(_mm256_and_si256(m, exc), zero);
+        uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(hasAll, hasNone)));
+        if ((bits & 0x0000FFFFu) == 0x0000FFFFu) onMatch(static_cast<uint32_t>(i));
+        if ((bits & 0xFFFF0000u) == 0xFFFF0000u) onMatch(static_cast<uint32_t>(i + 1));
+    }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128i inc128 = _mm_load_si128(reinterpret_cast<const __m128i*>(&include));
+    const __m128i exc128 = _mm_load_si128(reinterpret_cast<const __m128i*>(&exclude));
+    const __m128i zero128 = _mm_setzero_si128();
+    for (; i < count; ++i) {
+        __m128i m = _mm_load_si128(reinterpret_cast<const __m128i*>(masks + i));
+        __m128i hasAll = _mm_cmpeq_epi32(_mm_and_si128(m, inc128), inc128);
+        __m128i hasNone = _mm_cmpeq_epi32(_mm_and_si128(m, exc128), zero128);
+        if (_mm_movemask_epi8(_mm_and_si128(hasAll, hasNone)) == 0xFFFF) {
+            onMatch(static_cast<uint32_t>(i));
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint64x2_t inc128 = vld1q_u64(include.words);
+    const uint64x2_t exc128 = vld1q_u64(exclude.words);
+    const uint64x2_t zero128 = vdupq_n_u64(0);
+    for (; i < count; ++i) {
+        uint64x2_t m = vld1q_u64(masks[i].words);
+        uint64x2_t ok = vandq_u64(vceqq_u64(vandq_u64(m, inc128), inc128),
+                                  vceqq_u64(vandq_u64(m, exc128), zero128));
+        if ((vgetq_lane_u64(ok, 0) & vgetq_lane_u64(ok, 1)) == ~uint64_t(0)) {
+            onMatch(static_cast<uint32_t>(i));
+        }
+    }
+#else
+    for (; i < count; ++i) {
+        if (masks[i].matches(include, exclude)) {
+            onMatch(static_cast<uint32_t>(i));
+        }
+    }
+#endif
+}
+
+void SceneTree::findNodesByTags(const TagQuery& query, std::vector<SceneNode*>& out) const {
+    out.clear();
+    if (query.unsatisfiable || m_slot_nodes.empty()) return;
+
+    bool needsOverflowCheck = !query.overflowInclude.empty() || !query.overflowExclude.empty();
+    scanTagMasks(m_slot_tags.data(), m_slot_tags.size(), query.include, query.exclude, [&](uint32_t slot) {
+        SceneNode* node = m_slot_nodes[slot];
+        if (needsOverflowCheck) {
+            bool ok = std::all_of(query.overflowInclude.begin(), query.overflowInclude.end(),
+                                  [node](StringAtom tag) { return node->hasTag(tag); }) &&
+                      std::none_of(query.overflowExclude.begin(), query.overflowExclude.end(),
+                                   [node](StringAtom tag) { return node->hasTag(tag); });
+            if (!ok) return;
+        }
+        out.push_back(node);
+    });
+}
+
+std::vector<SceneNode*> SceneTree::findNodesByTags(const TagQuery& query) const {
+    std::vector<SceneNode*> results;
+    findNodesByTags(query, results);
+    return results;
+}
+
+void SceneTree::invalidateHierarchyCaches() {
+    m_reach_dirty = true;
+    m_linear_dirty = true;
+}
+
+const std::vector<SceneTree::LinearNode>& SceneTree::getLinearOrder() const {
+    if (m_linear_dirty) {
+        m_linear_order.clear();
+        m_linear_slots.clear();
+        std::fill(m_slot_linear.begin(), m_slot_linear.end(), kNoSlot);
+        if (m_root) appendLinearOrder(m_root.get(), LinearNode::kNoParent);
+        m_linear_dirty = false;
+    }
+    return m_linear_order;
+}
+
+// Appends the not yet linearized nodes reachable from 'start' in topological order. This is
+// Kahn's algorithm driven by a stack: a node is emitted once all of its parents inside the
+// subtree have been, so a pure tree comes out in exact pre-order. Returns false without
+// changing anything if the subtree reaches a node that is already in the array, or a node
+// this tree does not index; the caller then falls back to a full rebuild.
+bool SceneTree::appendLinearOrder(SceneNode* start, uint32_t parentIndex) const {
+    auto slotOf = [this](const SceneNode* node) -> uint32_t {
+        auto it = m_node_lookup.find(node->getId());
+        return (it != m_node_lookup.end() && it->second.node == node) ? it->second.slot : kNoSlot;
+    };
+
+    // 1. Count the in-subtree parents of every reachable node
+    std::unordered_map<uint32_t, uint32_t> indegree;
+    std::vector<uint32_t> stack;
+    uint32_t startSlot = slotOf(start);
+    if (startSlot == kNoSlot || m_slot_linear[startSlot] != kNoSlot) return false;
+    indegree[startSlot] = 0;
+    stack.push_back(startSlot);
+    while (!stack.empty()) {
+        uint32_t slot = stack.back();
+        stack.pop_back();
+        for (const auto& child : m_slot_nodes[slot]->getChildren()) {
+            if (!child) continue;
+            uint32_t childSlot = slotOf(child.get());
+            if (childSlot == kNoSlot || m_slot_linear[childSlot] != kNoSlot) return false;
+            auto [it, first] = indegree.try_emplace(childSlot, 0);
+            ++it->second;
+            if (first) stack.push_back(childSlot);
+        }
+    }
+
+    // 2. Emit; a node hangs off the last parent that released it, at its deepest path
+    const uint32_t base = static_cast<uint32_t>(m_linear_order.size());
+    m_linear_order.reserve(base + indegree.size());
+    m_linear_slots.reserve(base + indegree.size());
+    std::unordered_map<uint32_t, LinearNode> pending;
+    uint32_t startDepth = parentIndex == LinearNode::kNoParent ? 0 : m_linear_order[parentIndex].depth + 1;
+    pending[startSlot] = {start, parentIndex, startDepth};
+    stack.push_back(startSlot);
+    while (!stack.empty()) {
+        uint32_t slot = stack.back();
+        stack.pop_back();
+        uint32_t index = static_cast<uint32_t>(m_linear_order.size());
+        LinearNode entry = pending[slot];
+        pending.erase(slot);
+        m_linear_order.push_back(entry);
+        m_linear_slots.push_back(slot);
+        m_slot_linear[slot] = index;
+
+        const auto& children = entry.node->getChildren();
+        for (auto it = children.rbegin(); it != children.rend(); ++it) {
+            if (!*it) continue;
+            uint32_t childSlot = slotOf(it->get());
+            LinearNode& childEntry = pending[childSlot];
+            childEntry.node = it->get();
+            childEntry.parent = index;
+            childEntry.depth = std::max(childEntry.depth, entry.depth + 1);
+            if (--indegree[childSlot] == 0) stack.push_back(childSlot);
+        }
+    }
+    return true;
+}
+
+// Closes the holes left by eraseNodeEntry, preserving order. The result is still topological as
+// long as no surviving node lost a parent it was attached under.
+void SceneTree::compactLinearOrder() {
+    if (m_linear_dirty) return;
+    std::vector<uint32_t> remap(m_linear_order.size(), LinearNode::kNoParent);
+    uint32_t out = 0;
+    for (uint32_t i = 0; i < m_linear_order.size(); ++i) {
+        if (!m_linear_order[i].node) continue;
+        LinearNode entry = m_linear_order[i];
+        if (entry.parent != LinearNode::kNoParent) {
+            entry.parent = remap[entry.parent];
+            if (entry.parent == LinearNode::kNoParent) {
+                m_linear_dirty = true; // Parent is gone but the node stayed
+                return;
             }
         }
+        remap[i] = out;
+        m_linear_order[out] = entry;
+        m_linear_slots[out] = m_linear_slots[i];
+        m_slot_linear[m_linear_slots[out]] = out;
+        ++out;
     }
+    m_linear_order.resize(out);
+    m_linear_slots.resize(out);
+}
 
-    node->unregisterObserver(m_node_observer.get());
+// Reachability labeling used for O(1) ancestor checks.
+// A DFS from the root that visits every node once assigns each node the pre-order interval
+// [pre, post] of its spanning-tree subtree. In a pure tree that interval is exactly the set of
+// descendants. In a DAG, a node reached again through a second parent is not re-entered; the
+// edge is a "cross" edge and the second parent (and its ancestors) get an extra interval
+// covering the shared subtree. Extra intervals are only stored for nodes that need them.
+void SceneTree::rebuildReachability() const {
+    const size_t count = m_slot_nodes.size();
+    m_slot_pre.assign(count, 0);
+    m_slot_post.assign(count, 0);
+    m_extra_intervals.clear();
+    if (!m_root || count == 0) return;
+
+    auto slotOf = [this](const SceneNode* node) -> uint32_t {
+        auto it = m_node_lookup.find(node->getId());
+        return (it != m_node_lookup.end() && it->second.node == node) ? it->second.slot : kNoSlot;
+    };
 
-    for (const auto& child : node->getChildren()) {
-        removeNodeMap(child);
+    struct Frame {
+        uint32_t slot;
+        size_t next_child;
+    };
+    std::vector<uint8_t> visited(count, 0);
+    std::vector<Frame> stack;
+    std::vector<uint32_t> finish_order;
+    std::vector<std::pair<uint32_t, uint32_t>> cross_edges; // (parent slot, child slot)
+    finish_order.reserve(count);
+
+    uint32_t counter = 0;
+    uint32_t root_slot = slotOf(m_root.get());
+    if (root_slot == kNoSlot) return;
+    visited[root_slot] = 1;
+    m_slot_pre[root_slot] = counter++;
+    stack.push_back({root_slot, 0});
+
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const auto& children = m_slot_nodes[frame.slot]->getChildren();
+        if (frame.next_child < children.size()) {
+            const SceneNode* child = children[frame.next_child++].get();
+            uint32_t child_slot = child ? slotOf(child) : kNoSlot;
+            if (child_slot == kNoSlot) continue; // Not indexed by this tree
+            if (visited[child_slot]) {
+                cross_edges.emplace_back(frame.slot, child_slot);
+                continue;
+            }
+            visited[child_slot] = 1;
+            m_slot_pre[child_slot] = counter++;
+            stack.push_back({child_slot, 0});
+        } else {
+            m_slot_post[frame.slot] = counter - 1;
+            finish_order.push_back(frame.slot);
+            stack.pop_back();
+        }
     }
+
+    if (cross_edges.empty()) return; // Pure tree: the spanning intervals are exact
+
+    // Collect the extra intervals bottom-up. In finish order every descendant (including the
+    // target of a cross edge, which finished before the edge was seen) is complete first.
+    std::unordered_map<uint32_t, std::vector<uint32_t>> cross_targets;
+    for (auto [parent, child] : cross_edges) cross_targets[parent].push_back(child);
+
+    for (uint32_t slot : finish_order) {
+        std::vector<Interval> intervals;
+        auto addWithExtras = [&](uint32_t target) {
+            intervals.push_back({m_slot_pre[target], m_slot_post[target]});
+            if (auto it = m_extra_intervals.find(target); it != m_extra_intervals.end()) {
+                intervals.insert(intervals.end(), it->second.begin(), it->second.end());
+            }
+        };
+        for (const auto& child : m_slot_nodes[slot]->getChildren()) {
+            uint32_t child_slot = child ? slotOf(child.get()) : kNoSlot;
+            if (child_slot == kNoSlot) continue;
+            if (auto it = m_extra_intervals.find(child_slot); it != m_extra_intervals.end()) {
+                intervals.insert(intervals.end(), it->second.begin(), it->second.end());
+            }
+        }
+        if (auto it = cross_targets.find(slot); it != cross_targets.end()) {
+            for (uint32_t target : it->second) addWithExtras(target);
+        }
+        if (intervals.empty()) continue;
+
+        // Drop what the node's own interval already covers, then sort and merge
+        const uint32_t pre = m_slot_pre[slot];
+        const uint32_t post = m_slot_post[slot];
+        intervals.erase(std::remove_if(intervals.begin(), intervals.end(),
+            [pre, post](const Interval& i) { return i.first >= pre && i.second <= post; }), intervals.end());
+        if (intervals.empty()) continue;
+        std::sort(intervals.begin(), intervals.end());
+        std::vector<Interval> merged;
+        for (const auto& i : intervals) {
+            if (!merged.empty() && i.first <= merged.back().second + 1) {
+                merged.back().second = std::max(merged.back().second, i.second);
+            } else {
+                merged.push_back(i);
+            }
+        }
+        m_extra_intervals.emplace(slot, std::move(merged));
+    }
+}
+
+void SceneTree::markEffectiveDirty(ObjectId id) {
+    auto it = m_node_lookup.find(id);
+    if (it == m_node_lookup.end()) return;
+    uint8_t& flags = m_slot_effective[it->second.slot];
+    if (flags & kEffectiveQueued) return;
+    flags |= kEffectiveQueued;
+    m_effective_pending.push_back(id);
+}
+
+// Recomputes the pending nodes, parents before children (ranks grow along every edge), and
+// descends only below nodes whose value changed
+void SceneTree::updateEffectiveState() const {
+    if (m_effective_pending.empty()) return;
+
+    using RankedSlot = std::pair<int64_t, uint32_t>; // Topological rank, slot
+    std::priority_queue<RankedSlot, std::vector<RankedSlot>, std::greater<RankedSlot>> worklist;
+    for (ObjectId id : m_effective_pending) {
+        auto it = m_node_lookup.find(id);
+        if (it == m_node_lookup.end()) continue; // Left the tree since
+        m_slot_effective[it->second.slot] |= kEffectiveQueued;
+        worklist.push({it->second.node->m_topo_rank, it->second.slot});
+    }
+    m_effective_pending.clear();
+
+    while (!worklist.empty()) {
+        uint32_t slot = worklist.top().second;
+        worklist.pop();
+        uint8_t previous = m_slot_effective[slot];
+        if (!(previous & kEffectiveQueued)) continue; // Reached twice, already recomputed
+
+        SceneNode* node = m_slot_nodes[slot];
+        ObjectStatus status = node->getStatus();
+        uint8_t flags = 0;
+        if (status == ObjectStatus::Active) flags |= kEffectiveActive;
+        if (node->isVisible() && status != ObjectStatus::Hidden) flags |= kEffectiveVisible;
+        for (const auto& weakParent : node->getParents()) {
+            if (flags == 0) break;
+            auto parent = weakParent.lock();
+            if (!parent) continue;
+            auto it = m_node_lookup.find(parent->getId());
+            if (it == m_node_lookup.end() || it->second.node != parent.get()) continue;
+            flags &= m_slot_effective[it->second.slot] | ~(kEffectiveActive | kEffectiveVisible);
+        }
+        m_slot_effective[slot] = flags;
+        if (!(previous & kEffectiveUnknown) && (previous & (kEffectiveActive | kEffectiveVisible)) == flags) continue;
+
+        for (const auto& child : node->getChildren()) {
+            auto it = m_node_lookup.find(child->getId());
+            if (it == m_node_lookup.end() || it->second.node != child.get()) continue;
+            uint8_t& childFlags = m_slot_effective[it->second.slot];
+            if (childFlags & kEffectiveQueued) continue;
+            childFlags |= kEffectiveQueued;
+            worklist.push({child->m_topo_rank, it->second.slot});
+        }
+    }
+}
+
+bool SceneTree::isEffectivelyActive(const SceneNode* node) const {
+    if (!node || !containsNode(node)) return false;
+    updateEffectiveState();
+    return (m_slot_effective[m_node_lookup.find(node->getId())->second.slot] & kEffectiveActive) != 0;
+}
+
+bool SceneTree::isEffectivelyVisible(const SceneNode* node) const {
+    if (!node || !containsNode(node)) return false;
+    updateEffectiveState();
+    return (m_slot_effective[m_node_lookup.find(node->getId())->second.slot] & kEffectiveVisible) != 0;
+}
+
+void SceneTree::findByEffectiveFlag(uint8_t flag, std::vector<SceneNode*>& out) const {
+    updateEffectiveState();
+    out.clear();
+    const uint8_t* flags = m_slot_effective.data();
+    for (size_t slot = 0, count = m_slot_effective.size(); slot < count; ++slot) {
+        if (flags[slot] & flag) out.push_back(m_slot_nodes[slot]);
+    }
+}
+
+void SceneTree::findEffectivelyVisibleNodes(std::vector<SceneNode*>& out) const {
+    findByEffectiveFlag(kEffectiveVisible, out);
+}
+
+void SceneTree::findEffectivelyActiveNodes(std::vector<SceneNode*>& out) const {
+    findByEffectiveFlag(kEffectiveActive, out);
+}
+
+std::shared_ptr<LiveQuery> SceneTree::createLiveQuery(LiveQuerySpec spec) {
+    // Give the tags a bit now, so nodes that are tagged later show up in the masks
+    for (StringAtom tag : spec.include) {
+        if (tag.isValid()) m_tag_registry.registerTag(tag);
+    }
+    for (StringAtom tag : spec.exclude) {
+        if (tag.isValid()) m_tag_registry.registerTag(tag);
+    }
+    std::shared_ptr<LiveQuery> query(new LiveQuery(this, std::move(spec)));
+    query->m_query = makeTagQuery(query->m_spec.include, query->m_spec.exclude);
+
+    syncLiveQueries(); // Existing queries catch up before the list changes
+    rebuildLiveQuery(*query);
+    m_live_queries.push_back(query);
+    return query;
+}
+
+bool SceneTree::matchesLiveQuery(const LiveQuery& query, uint32_t slot) const {
+    const TagQuery& tags = query.m_query;
+    SceneNode* node = m_slot_nodes[slot];
+    if (tags.unsatisfiable || !(query.m_spec.statuses & statusBit(node->getStatus()))) return false;
+    if (!m_slot_tags[slot].matches(tags.include, tags.exclude)) return false;
+    for (StringAtom tag : tags.overflowInclude) {
+        if (!node->hasTag(tag)) return false;
+    }
+    for (StringAtom tag : tags.overflowExclude) {
+        if (node->hasTag(tag)) return false;
+    }
+    if (query.m_spec.scope) {
+        auto it = m_node_lookup.find(*query.m_spec.scope);
+        if (it == m_node_lookup.end() || !isAncestorOf(it->second.node, node)) return false;
+    }
+    return true;
+}
+
+void SceneTree::rebuildLiveQuery(LiveQuery& query) const {
+    query.clear();
+    const TagQuery& tags = query.m_query;
+    if (tags.unsatisfiable) return;
+    scanTagMasks(m_slot_tags.data(), m_slot_tags.size(), tags.include, tags.exclude, [&](uint32_t slot) {
+        if (matchesLiveQuery(query, slot)) query.setMember(m_slot_nodes[slot], true);
+    });
+}
+
+void SceneTree::noteLiveQueryChange(SceneNode* node, NodeProperty prop, const PropertyValue& oldVal,
+                                    const PropertyValue& newVal) {
+    if (m_query_rescan) return;
+    switch (prop) {
+    case NodeProperty::TagAdded:
+    case NodeProperty::TagRemoved:
+    case NodeProperty::Status:
+        m_query_pending.push_back(node->getId());
+        break;
+    case NodeProperty::Hierarchy:
+        // 'node' is the parent; the child's subtree may have entered or left a scope
+        m_query_pending_scopes.push_back(newVal.has_value() ? newVal.get<ObjectId>() : oldVal.get<ObjectId>());
+        break;
+    default:
+        return;
+    }
+    if (m_query_pending.size() + m_query_pending_scopes.size() > m_slot_nodes.size()) {
+        m_query_rescan = true;
+        m_query_pending.clear();
+        m_query_pending_scopes.clear();
+    }
+}
+
+void SceneTree::syncLiveQueries() const {
+    if (m_query_pending.empty() && m_query_pending_scopes.empty() && !m_query_rescan) return;
+
+    std::vector<std::shared_ptr<LiveQuery>> queries;
+    queries.reserve(m_live_queries.size());
+    bool anyScoped = false;
+    m_live_queries.erase(std::remove_if(m_live_queries.begin(), m_live_queries.end(),
+                                        [&](const std::weak_ptr<LiveQuery>& weakQuery) {
+                                            auto query = weakQuery.lock();
+                                            if (!query) return true;
+                                            anyScoped |= query->m_spec.scope.has_value();
+                                            queries.push_back(std::move(query));
+                                            return false;
+                                        }),
+                         m_live_queries.end());
+
+    if (m_query_rescan) {
+        for (const auto& query : queries) rebuildLiveQuery(*query);
+    } else {
+        for (ObjectId id : m_query_pending) {
+            auto it = m_node_lookup.find(id);
+            if (it == m_node_lookup.end()) continue; // Left the tree; already removed
+            for (const auto& query : queries) {
+                query->setMember(it->second.node, matchesLiveQuery(*query, it->second.slot));
+            }
+        }
+        for (ObjectId id : m_query_pending_scopes) {
+            auto it = anyScoped ? m_node_lookup.find(id) : m_node_lookup.end();
+            if (it == m_node_lookup.end()) continue;
+            for (SceneNode* node : it->second.node->preOrder()) {
+                auto entry = m_node_lookup.find(node->getId());
+                if (entry == m_node_lookup.end() || entry->second.node != node) continue;
+                for (const auto& query : queries) {
+                    if (query->m_spec.scope) query->setMember(node, matchesLiveQuery(*query, entry->second.slot));
+                }
+            }
+        }
+        // A scope that left the tree takes its whole result set with it, including nodes that
+        // stay in the tree through another parent
+        for (const auto& query : queries) {
+            if (query->m_spec.scope && !query->m_nodes.empty() && !m_node_lookup.count(*query->m_spec.scope)) {
+                query->clear();
+            }
+        }
+    }
+    m_query_pending.clear();
+    m_query_pending_scopes.clear();
+    m_query_rescan = false;
+}
+
+bool SceneTree::isAncestorOf(const SceneNode* ancestor, const SceneNode* node) const {
+    if (!ancestor || !node) return false;
+    auto a_it = m_node_lookup.find(ancestor->getId());
+    auto n_it = m_node_lookup.find(node->getId());
+    if (a_it == m_node_lookup.end() || a_it->second.node != ancestor ||
+        n_it == m_node_lookup.end() || n_it->second.node != node) {
+        return false;
+    }
+    // Readers may race to the first check after a structural change; one of them rebuilds
+    if (m_reach_dirty.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(m_reach_mutex);
+        if (m_reach_dirty.load(std::memory_order_relaxed)) {
+            rebuildReachability();
+            m_reach_dirty.store(false, std::memory_order_release);
+        }
+    }
+
+    const uint32_t a = a_it->second.slot;
+    const uint32_t pre = m_slot_pre[n_it->second.slot];
+    if (pre >= m_slot_pre[a] && pre <= m_slot_post[a]) return true;
+
+    auto extra_it = m_extra_intervals.find(a);
+    if (extra_it == m_extra_intervals.end()) return false;
+    const auto& intervals = extra_it->second;
+    auto it = std::upper_bound(intervals.begin(), intervals.end(), Interval{pre, UINT32_MAX});
+    return it != intervals.begin() && std::prev(it)->second >= pre;
 }
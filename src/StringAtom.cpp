@@ -0,0 +1,104 @@
+#include "SceneTree/StringAtom.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+static constexpr uint32_t kChunkBits = 12;
+static constexpr uint32_t kChunkSize = 1u << kChunkBits;
+static constexpr uint32_t kMaxChunks = 1u << 16;
+
+struct StringAtomTable::Impl {
+    mutable std::shared_mutex mutex;
+    // Keys view into the chunk storage, which never moves
+    std::unordered_map<std::string_view, uint32_t> index;
+    std::array<std::atomic<std::string*>, kMaxChunks> chunks{};
+    std::atomic<uint32_t> count{0};
+
+    ~Impl() {
+        for (auto& chunk : chunks) {
+            delete[] chunk.load(std::memory_order_relaxed);
+        }
+    }
+};
+
+StringAtomTable& StringAtomTable::instance() {
+    // Intentionally never destroyed so that atoms stay valid during static destruction
+    static StringAtomTable* table = new StringAtomTable();
+    return *table;
+}
+
+StringAtomTable::StringAtomTable() : m_impl(new Impl()) {
+    intern(std::string_view()); // Atom 0 is always the empty string
+}
+
+StringAtomTable::~StringAtomTable() {
+    delete m_impl;
+}
+
+StringAtom StringAtomTable::intern(std::string_view str) {
+    {
+        std::shared_lock<std::shared_mutex> lock(m_impl->mutex);
+        auto it = m_impl->index.find(str);
+        if (it != m_impl->index.end()) {
+            return StringAtom(it->second);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_impl->mutex);
+    auto it = m_impl->index.find(str);
+    if (it != m_impl->index.end()) {
+        return StringAtom(it->second);
+    }
+
+    uint32_t index = m_impl->count.load(std::memory_order_relaxed);
+    uint32_t chunk_index = index >> kChunkBits;
+    if (chunk_index >= kMaxChunks) {
+        throw std::length_error("StringAtomTable is full.");
+    }
+    std::string* chunk = m_impl->chunks[chunk_index].load(std::memory_order_relaxed);
+    if (!chunk) {
+        chunk = new std::string[kChunkSize];
+        m_impl->chunks[chunk_index].store(chunk, std::memory_order_release);
+    }
+    std::string& slot = chunk[index & (kChunkSize - 1)];
+    slot.assign(str.data(), str.size());
+    m_impl->index.emplace(std::string_view(slot), index);
+    m_impl->count.store(index + 1, std::memory_order_release);
+    return StringAtom(index);
+}
+
+StringAtom StringAtomTable::find(std::string_view str) const {
+    std::shared_lock<std::shared_mutex> lock(m_impl->mutex);
+    auto it = m_impl->index.find(str);
+    return it != m_impl->index.end() ? StringAtom(it->second) : StringAtom::invalid();
+}
+
+const std::string& StringAtomTable::str(StringAtom atom) const {
+    static const std::string empty;
+    uint32_t index = atom.raw();
+    if (!atom.isValid() || index >= m_impl->count.load(std::memory_order_acquire)) {
+        return empty;
+    }
+    std::string* chunk = m_impl->chunks[index >> kChunkBits].load(std::memory_order_acquire);
+    return chunk[index & (kChunkSize - 1)];
+}
+
+size_t StringAtomTable::size() const {
+    return m_impl->count.load(std::memory_order_acquire);
+}
+
+StringAtom StringAtom::intern(std::string_view str) {
+    return StringAtomTable::instance().intern(str);
+}
+
+StringAtom StringAtom::find(std::string_view str) {
+    return StringAtomTable::instance().find(str);
+}
+
+const std::string& StringAtom::str() const {
+    return StringAtomTable::instance().str(*this);
+}
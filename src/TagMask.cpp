@@ -0,0 +1,24 @@
+#include "SceneTree/TagMask.h"
+
+uint32_t TagRegistry::registerTag(StringAtom tag) {
+    auto it = m_bits.find(tag);
+    if (it != m_bits.end()) {
+        return it->second;
+    }
+    uint32_t bit = kNoBit;
+    if (m_tags.size() < TagMask::kBits) {
+        bit = static_cast<uint32_t>(m_tags.size());
+        m_tags.push_back(tag);
+    }
+    m_bits.emplace(tag, bit);
+    return bit;
+}
+
+uint32_t TagRegistry::bitFor(StringAtom tag) const {
+    auto it = m_bits.find(tag);
+    return it != m_bits.end() ? it->second : kNoBit;
+}
+
+bool TagRegistry::isRegistered(StringAtom tag) const {
+    return m_bits.find(tag) != m_bits.end();
+}
@@ -1,8 +1,11 @@
 #include "gtest/gtest.h"
 #include "SceneTree/SceneIO.h"
+#include "SceneTree/SceneBinary.h"
 #include "SceneTree/SceneTree.h"
 #include "SceneTree/SceneNode.h"
 #include <filesystem>
+#include <cstddef>
+#include <cstring>
 #include <fstream>
 
 namespace fs = std::filesystem;
@@ -84,6 +87,25 @@ TEST_F(SceneIOTest, SaveAndLoadEmptyTags) {
     EXPECT_TRUE(loadedTree->getRoot()->getTags().empty());
 }
 
+TEST_F(SceneIOTest, SaveAndLoadVisibility) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto child = std::make_shared<SceneNode>(2, "Child");
+    child->setVisible(false);
+    root->addChild(child);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    fs::path filepath = testDir / "visibility_test.json";
+    ASSERT_TRUE(SceneIO::saveSceneTree(*tree, filepath.string()));
+
+    auto loadedTree = SceneIO::loadSceneTree(filepath.string());
+    ASSERT_NE(loadedTree, nullptr);
+    EXPECT_TRUE(loadedTree->getRoot()->isVisible());
+    auto loadedChild = loadedTree->findNode(2);
+    ASSERT_NE(loadedChild, nullptr);
+    EXPECT_FALSE(loadedChild->isVisible());
+    EXPECT_FALSE(loadedTree->isEffectivelyVisible(loadedChild));
+}
+
 TEST_F(SceneIOTest, LoadLegacyFormat) {
     // Manually create a legacy JSON file (no format_version wrapper, root object at top level)
     fs::path filepath = testDir / "legacy_test.json";
@@ -127,4 +149,343 @@ TEST_F(SceneIOTest, LoadFutureVersion) {
     
     // Verify the warning was printed
     EXPECT_NE(output.find("Warning: File version (999) is newer"), std::string::npos);
-}
\ No newline at end of file
+}
+
+TEST_F(SceneIOTest, LoadStreamsKeysInAnyOrder) {
+    // The loader never builds a DOM, so check it copes with what a DOM would hide: children
+    // before the id, unknown nested values, non-object children and a child without an id
+    fs::path filepath = testDir / "stream_test.json";
+    std::ofstream ofs(filepath);
+    ofs << R"({
+        "root": {
+            "children": [
+                { "tags": ["Enemy", 7, {"x": 1}], "visible": false, "id": 2 },
+                42,
+                { "name": "NoId", "children": [{ "id": 9 }] },
+                { "extra": {"children": [{"id": 8}]}, "id": 3, "status": "Broken" }
+            ],
+            "name": "First",
+            "name": "Root",
+            "id": 1
+        },
+        "metadata": { "root": [1, 2, {"id": 5}] },
+        "format_version": 1
+    })";
+    ofs.close();
+
+    testing::internal::CaptureStderr();
+    auto tree = SceneIO::loadSceneTree(filepath.string());
+    std::string output = testing::internal::GetCapturedStderr();
+
+    ASSERT_NE(tree, nullptr);
+    auto root = tree->getRoot();
+    EXPECT_EQ(root->getId(), 1);
+    EXPECT_EQ(root->getName(), "Root");
+    ASSERT_EQ(root->getChildren().size(), 2u);
+
+    auto first = root->getChildren()[0];
+    EXPECT_EQ(first->getId(), 2);
+    EXPECT_EQ(first->getName(), "Unnamed");
+    EXPECT_TRUE(first->hasTag("Enemy"));
+    EXPECT_EQ(first->getTags().size(), 1u);
+    EXPECT_FALSE(first->isVisible());
+
+    auto second = root->getChildren()[1];
+    EXPECT_EQ(second->getId(), 3);
+    EXPECT_EQ(second->getStatus(), ObjectStatus::Broken);
+    EXPECT_TRUE(second->getChildren().empty());
+
+    EXPECT_EQ(tree->findNode(8), nullptr);
+    EXPECT_NE(output.find("Node missing valid 'id'"), std::string::npos);
+
+    // Non-object documents are rejected without a DOM as well
+    std::ofstream(testDir / "array.json") << "[1, 2, 3]";
+    EXPECT_EQ(SceneIO::loadSceneTree((testDir / "array.json").string()), nullptr);
+}
+
+TEST_F(SceneIOTest, LoadIgnoresKeysOfTheOtherLayout) {
+    // Each document carries a stray value that only the other layout would read; none of them
+    // may warn, and references never cross from one reading to the other
+    auto load = [&](const std::string& name, const char* text, std::string& output) {
+        std::ofstream(testDir / name) << text;
+        testing::internal::CaptureStderr();
+        auto tree = SceneIO::loadSceneTree((testDir / name).string());
+        output = testing::internal::GetCapturedStderr();
+        return tree;
+    };
+    std::string output;
+
+    auto versionFirst = load("version_first.json", R"({
+        "format_version": 2,
+        "children": [{ "name": "NoId" }],
+        "root": { "id": 1 }
+    })", output);
+    ASSERT_NE(versionFirst, nullptr);
+    EXPECT_EQ(versionFirst->getRoot()->getId(), 1);
+    EXPECT_EQ(output, "");
+
+    auto versionLast = load("version_last.json", R"({
+        "children": [{ "name": "NoId" }, { "id": 7, "key": 1 }],
+        "root": { "id": 1, "children": [{ "ref": 1 }] },
+        "format_version": 2
+    })", output);
+    ASSERT_NE(versionLast, nullptr);
+    EXPECT_TRUE(versionLast->getRoot()->getChildren().empty());
+    EXPECT_EQ(output.find("missing valid 'id'"), std::string::npos);
+    EXPECT_NE(output.find("Reference to unknown node key (1)"), std::string::npos);
+
+    auto legacy = load("legacy_with_root.json", R"({
+        "root": { "name": "NoId", "children": [{ "ref": 3 }] },
+        "id": 1,
+        "children": [{ "id": 2 }]
+    })", output);
+    ASSERT_NE(legacy, nullptr);
+    EXPECT_EQ(legacy->getRoot()->getId(), 1);
+    EXPECT_EQ(legacy->getRoot()->getChildren().size(), 1u);
+    EXPECT_EQ(output, "");
+}
+
+TEST_F(SceneIOTest, SaveAndLoadSharedNodesOnce) {
+    // 30 stacked diamonds: 2^30 root-to-leaf paths, but only 91 nodes
+    constexpr int kDiamonds = 30;
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto top = root;
+    unsigned int nextId = 2;
+    for (int i = 0; i < kDiamonds; ++i) {
+        auto left = std::make_shared<SceneNode>(nextId++, "Left");
+        auto right = std::make_shared<SceneNode>(nextId++, "Right");
+        auto bottom = std::make_shared<SceneNode>(nextId++, "Bottom");
+        bottom->addTag("Joint");
+        top->addChild(left);
+        top->addChild(right);
+        left->addChild(bottom);
+        right->addChild(bottom);
+        top = bottom;
+    }
+    auto tree = std::make_unique<SceneTree>(root);
+
+    for (SceneFormat format : {SceneFormat::Json, SceneFormat::Cbor}) {
+        SCOPED_TRACE(static_cast<int>(format));
+        fs::path filepath = testDir / "diamonds";
+        ASSERT_TRUE(SceneIO::saveSceneTree(*tree, filepath.string(), format));
+        EXPECT_LT(fs::file_size(filepath), 1024u * 1024u); // Written per path, it would be gigabytes
+
+        auto loadedTree = SceneIO::loadSceneTree(filepath.string());
+        ASSERT_NE(loadedTree, nullptr);
+        for (unsigned int id = 1; id < nextId; ++id) {
+            ASSERT_NE(loadedTree->findNode(id), nullptr) << id;
+        }
+        // Each bottom node is one node with both of its diamond's sides as parents
+        for (unsigned int id = 4; id < nextId; id += 3) {
+            SceneNode* bottom = loadedTree->findNode(id);
+            ASSERT_EQ(bottom->getParents().size(), 2u) << id;
+            EXPECT_TRUE(bottom->hasTag("Joint"));
+            EXPECT_EQ(loadedTree->findNode(id - 2)->getChildren().front().get(), bottom);
+            EXPECT_EQ(loadedTree->findNode(id - 1)->getChildren().front().get(), bottom);
+        }
+
+        // The loaded DAG attaches without id collisions
+        auto host = std::make_unique<SceneTree>(std::make_shared<SceneNode>(1000, "Host"));
+        EXPECT_TRUE(host->attach(host->getRoot().get(), std::move(loadedTree)));
+        EXPECT_NE(host->findNode(nextId - 1), nullptr);
+    }
+
+    // Two distinct nodes with the same id: the reference must link the shared one, not the
+    // first node written with that id
+    auto dupRoot = std::make_shared<SceneNode>(1, "Root");
+    auto a = std::make_shared<SceneNode>(2, "A");
+    auto b = std::make_shared<SceneNode>(3, "B");
+    auto c = std::make_shared<SceneNode>(4, "C");
+    a->addChild(std::make_shared<SceneNode>(5, "X"));
+    auto y = std::make_shared<SceneNode>(5, "Y");
+    b->addChild(y);
+    c->addChild(y);
+    dupRoot->addChildren({a, b, c});
+    SceneTree dupTree(dupRoot);
+    fs::path dupPath = testDir / "duplicate_ids.json";
+    ASSERT_TRUE(SceneIO::saveSceneTree(dupTree, dupPath.string()));
+    auto dupLoaded = SceneIO::loadSceneTree(dupPath.string());
+    ASSERT_NE(dupLoaded, nullptr);
+    SceneNode* loadedB = dupLoaded->findNode(3);
+    SceneNode* loadedC = dupLoaded->findNode(4);
+    ASSERT_NE(loadedB, nullptr);
+    ASSERT_NE(loadedC, nullptr);
+    ASSERT_EQ(loadedC->getChildren().size(), 1u);
+    EXPECT_EQ(loadedC->getChildren().front()->getName(), "Y");
+    EXPECT_EQ(loadedC->getChildren().front(), loadedB->getChildren().front());
+    EXPECT_EQ(dupLoaded->findNode(2)->getChildren().front()->getName(), "X");
+
+    // A reference to a node that was not written before it is dropped with a warning
+    fs::path dangling = testDir / "dangling_ref.json";
+    std::ofstream(dangling) << R"({"format_version": 2, "root": {"id": 1, "children": [{"ref": 7}, {"id": 2}]}})";
+    testing::internal::CaptureStderr();
+    auto loadedTree = SceneIO::loadSceneTree(dangling.string());
+    std::string output = testing::internal::GetCapturedStderr();
+    ASSERT_NE(loadedTree, nullptr);
+    EXPECT_EQ(loadedTree->getRoot()->getChildren().size(), 1u);
+    EXPECT_NE(output.find("Reference to unknown node key (7)"), std::string::npos);
+
+    // A keyed node dropped along with its id-less parent: the reference to it is dropped too,
+    // and it never resolves to a node built after it. A later node with the same key still
+    // becomes the shared node.
+    fs::path orphaned = testDir / "orphaned_key.json";
+    std::ofstream(orphaned) << R"({"format_version": 2, "root": {"id": 1, "children": [
+        {"name": "NoId", "children": [{"id": 2, "name": "Shared", "key": 1}]},
+        {"id": 3, "name": "Filler"},
+        {"ref": 1},
+        {"id": 4, "name": "Replacement", "key": 1},
+        {"id": 5, "children": [{"ref": 1}]}
+    ]}})";
+    testing::internal::CaptureStderr();
+    loadedTree = SceneIO::loadSceneTree(orphaned.string());
+    output = testing::internal::GetCapturedStderr();
+    ASSERT_NE(loadedTree, nullptr);
+    const auto& children = loadedTree->getRoot()->getChildren();
+    ASSERT_EQ(children.size(), 3u);
+    EXPECT_EQ(children[0]->getName(), "Filler");
+    EXPECT_EQ(children[1]->getName(), "Replacement");
+    ASSERT_EQ(children[2]->getChildren().size(), 1u);
+    EXPECT_EQ(children[2]->getChildren().front(), children[1]);
+    EXPECT_EQ(loadedTree->findNode(2), nullptr);
+    EXPECT_NE(output.find("Node missing valid 'id'"), std::string::npos);
+    EXPECT_NE(output.find("Reference to unknown node key (1)"), std::string::npos);
+}
+
+TEST_F(SceneIOTest, SaveAndLoadBinary) {
+    // Diamond: 'Shared' has two parents and must come back as one node
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto left = std::make_shared<SceneNode>(2, "Left", ObjectStatus::Inactive);
+    auto right = std::make_shared<SceneNode>(3, "Right");
+    auto shared = std::make_shared<SceneNode>(4, "Shared", ObjectStatus::Broken);
+    root->addTag("LevelRoot");
+    shared->addTag("Enemy");
+    shared->addTag("Destructible");
+    right->setVisible(false);
+    root->addChild(left);
+    root->addChild(right);
+    left->addChild(shared);
+    right->addChild(shared);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    fs::path filepath = testDir / "binary_test.scnb";
+    ASSERT_TRUE(SceneIO::saveSceneTree(*tree, filepath.string(), SceneFormat::Binary));
+    EXPECT_EQ(SceneIO::detectFormat(filepath.string()), SceneFormat::Binary);
+
+    auto loadedTree = SceneIO::loadSceneTree(filepath.string());
+    ASSERT_NE(loadedTree, nullptr);
+    EXPECT_EQ(loadedTree->getRoot()->getName(), "Root");
+    EXPECT_TRUE(loadedTree->getRoot()->hasTag("LevelRoot"));
+
+    auto loadedLeft = loadedTree->findNode(2);
+    auto loadedRight = loadedTree->findNode(3);
+    auto loadedShared = loadedTree->findNode(4);
+    ASSERT_NE(loadedLeft, nullptr);
+    ASSERT_NE(loadedRight, nullptr);
+    ASSERT_NE(loadedShared, nullptr);
+    EXPECT_EQ(loadedLeft->getStatus(), ObjectStatus::Inactive);
+    EXPECT_FALSE(loadedRight->isVisible());
+    EXPECT_EQ(loadedShared->getStatus(), ObjectStatus::Broken);
+    EXPECT_EQ(loadedShared->getTags().size(), 2);
+    EXPECT_TRUE(loadedShared->hasTag("Destructible"));
+    EXPECT_EQ(loadedShared->getParents().size(), 2);
+    EXPECT_EQ(loadedLeft->getChildren().front().get(), loadedShared);
+    EXPECT_EQ(loadedRight->getChildren().front().get(), loadedShared);
+}
+
+TEST_F(SceneIOTest, SaveAndLoadEveryEncoding) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto child = std::make_shared<SceneNode>(200, "Child", ObjectStatus::Inactive);
+    auto grandchild = std::make_shared<SceneNode>(70000, "Grandchild");
+    root->addTag("LevelRoot");
+    child->addTag("Enemy");
+    child->setVisible(false);
+    root->addChild(child);
+    child->addChild(grandchild);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    const SceneFormat formats[] = {SceneFormat::Json, SceneFormat::CompactJson, SceneFormat::Cbor,
+                                   SceneFormat::MessagePack, SceneFormat::Ubjson, SceneFormat::Bson};
+    auto pathOf = [&](SceneFormat format) {
+        return testDir / ("encoding_" + std::to_string(static_cast<int>(format)));
+    };
+    for (SceneFormat format : formats) {
+        SCOPED_TRACE(static_cast<int>(format));
+        fs::path filepath = pathOf(format);
+        ASSERT_TRUE(SceneIO::saveSceneTree(*tree, filepath.string(), format));
+
+        // Indented and compact JSON are both just JSON to the loader
+        SceneFormat expected = format == SceneFormat::CompactJson ? SceneFormat::Json : format;
+        EXPECT_EQ(SceneIO::detectFormat(filepath.string()), expected);
+
+        auto loadedTree = SceneIO::loadSceneTree(filepath.string());
+        ASSERT_NE(loadedTree, nullptr);
+        EXPECT_EQ(loadedTree->getRoot()->getId(), 1);
+        EXPECT_TRUE(loadedTree->getRoot()->hasTag("LevelRoot"));
+        auto loadedChild = loadedTree->findNode(200);
+        ASSERT_NE(loadedChild, nullptr);
+        EXPECT_EQ(loadedChild->getName(), "Child");
+        EXPECT_EQ(loadedChild->getStatus(), ObjectStatus::Inactive);
+        EXPECT_TRUE(loadedChild->hasTag("Enemy"));
+        EXPECT_FALSE(loadedChild->isVisible());
+        ASSERT_NE(loadedTree->findNode(70000), nullptr);
+        EXPECT_EQ(loadedTree->findNode(70000)->getParents().front().lock().get(), loadedChild);
+    }
+
+    // Compact JSON drops the indentation
+    auto sizeOf = [&](SceneFormat format) { return fs::file_size(pathOf(format)); };
+    EXPECT_LT(sizeOf(SceneFormat::CompactJson), sizeOf(SceneFormat::Json));
+    EXPECT_LT(sizeOf(SceneFormat::Cbor), sizeOf(SceneFormat::CompactJson));
+
+    // Forcing the wrong encoding fails cleanly
+    testing::internal::CaptureStderr();
+    auto wrong = SceneIO::loadSceneTree(pathOf(SceneFormat::Cbor).string(), SceneFormat::Bson);
+    std::string output = testing::internal::GetCapturedStderr();
+    EXPECT_EQ(wrong, nullptr);
+    EXPECT_NE(output.find("BSON Parse Error"), std::string::npos);
+}
+
+TEST_F(SceneIOTest, LoadRejectsCorruptBinary) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto child = std::make_shared<SceneNode>(2, "Child");
+    child->addTag("Enemy");
+    root->addChild(child);
+    auto tree = std::make_unique<SceneTree>(root);
+    std::vector<uint8_t> bytes = SceneBinary::encode(*tree);
+    ASSERT_NE(SceneBinary::decode(bytes.data(), bytes.size()), nullptr);
+
+    // Overwrites one 32-bit field and expects decode to fail with 'reason'
+    const size_t nodeTable = sizeof(SceneBinary::Header);
+    const size_t childTable = nodeTable + 2 * sizeof(SceneBinary::Node);
+    const size_t tagTable = childTable + sizeof(uint32_t);
+    auto expectRejected = [&](size_t offset, uint32_t value, const char* reason) {
+        std::vector<uint8_t> corrupt = bytes;
+        std::memcpy(corrupt.data() + offset, &value, sizeof(value));
+        testing::internal::CaptureStderr();
+        EXPECT_EQ(SceneBinary::decode(corrupt.data(), corrupt.size()), nullptr) << reason;
+        EXPECT_NE(testing::internal::GetCapturedStderr().find(reason), std::string::npos) << reason;
+    };
+    auto nodeField = [&](uint32_t index, size_t field) { return nodeTable + index * sizeof(SceneBinary::Node) + field; };
+    const size_t nameOffset = offsetof(SceneBinary::Node, name) + offsetof(SceneBinary::String, offset);
+
+    expectRejected(offsetof(SceneBinary::Header, version), 99, "newer than supported");
+    expectRejected(offsetof(SceneBinary::Header, byteOrder), 0x04030201u, "different byte order");
+    expectRejected(offsetof(SceneBinary::Header, nodeCount), 0, "no nodes");
+    expectRejected(offsetof(SceneBinary::Header, nodeCount), 3, "truncated");
+    expectRejected(nodeField(1, nameOffset), 1000, "outside its section");
+    expectRejected(nodeField(0, offsetof(SceneBinary::Node, childCount)), 2, "outside its section");
+    expectRejected(nodeField(1, offsetof(SceneBinary::Node, tagCount)), 2, "outside its section");
+    expectRejected(tagTable + offsetof(SceneBinary::String, offset), 1000, "outside the string pool");
+    // The root's child index pointing back at the root would form a cycle
+    expectRejected(childTable, 0, "out of order");
+    // A node record nobody lists
+    expectRejected(nodeField(0, offsetof(SceneBinary::Node, childCount)), 0, "not reachable");
+
+    testing::internal::CaptureStderr();
+    EXPECT_EQ(SceneBinary::decode(bytes.data(), bytes.size() - 1), nullptr);
+    EXPECT_NE(testing::internal::GetCapturedStderr().find("truncated"), std::string::npos);
+
+    // JSON files are still told apart
+    fs::path filepath = testDir / "detect_test.json";
+    ASSERT_TRUE(SceneIO::saveSceneTree(*tree, filepath.string()));
+    EXPECT_EQ(SceneIO::detectFormat(filepath.string()), SceneFormat::Json);
+}
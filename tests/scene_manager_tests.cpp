@@ -4,6 +4,7 @@
 #include <filesystem>
 #include <fstream>
 #include <thread>
+#include <atomic>
 #include <chrono>
 
 namespace fs = std::filesystem;
@@ -151,4 +152,83 @@ TEST_F(SceneManagerAsyncTest, TaskMerging) {
     // Verify that the second request (loadSceneAsync) triggered the switch
     ASSERT_NE(manager.getActiveSceneTree(), nullptr);
     EXPECT_EQ(manager.getActiveSceneTree()->getRoot()->getName(), "AsyncRoot");
-}
\ No newline at end of file
+}
+
+// Root -> 64 branches -> 100 leaves each; every branch also links one node shared by all branches
+static std::unique_ptr<SceneTree> makeWideTreeWithSharedNode(unsigned int& nodeCount) {
+    auto root = std::make_shared<SceneNode>(0, "Root");
+    auto shared = std::make_shared<SceneNode>(1, "Shared");
+    shared->addChild(std::make_shared<SceneNode>(2, "SharedLeaf"));
+    unsigned int nextId = 3;
+    for (int b = 0; b < 64; ++b) {
+        auto branch = std::make_shared<SceneNode>(nextId++, "Branch");
+        root->addChild(branch);
+        branch->addChild(shared);
+        for (int l = 0; l < 100; ++l) {
+            branch->addChild(std::make_shared<SceneNode>(nextId++, "Leaf"));
+        }
+    }
+    nodeCount = nextId;
+    return std::make_unique<SceneTree>(root);
+}
+
+TEST(SceneManagerTest, ParallelForEachVisitsEveryNodeOnce) {
+    SceneManager manager;
+    unsigned int nodeCount = 0;
+    auto tree = makeWideTreeWithSharedNode(nodeCount);
+
+    std::vector<std::atomic<int>> visits(nodeCount);
+    tree->parallelForEach(manager.getTaskExecutor(), [&](SceneNode& node) {
+        visits[node.getId().raw()].fetch_add(1);
+    }, 64);
+    for (unsigned int id = 0; id < nodeCount; ++id) {
+        EXPECT_EQ(visits[id].load(), 1) << "node " << id;
+    }
+
+    // Per-node writes are allowed; the resulting property events are serialized by the tree
+    tree->setBatchingEnabled(true);
+    tree->parallelForEach(manager.getTaskExecutor(), [](SceneNode& node) {
+        if (node.getName() == "Leaf") node.addTag("Visited");
+    });
+    tree->processEvents();
+    EXPECT_EQ(tree->findAllNodesByTag("Visited").size(), 64u * 100u);
+}
+
+TEST(SceneManagerTest, ParallelVisitHandlesSharedNodesPruneAndStop) {
+    SceneManager manager;
+    unsigned int nodeCount = 0;
+    auto tree = makeWideTreeWithSharedNode(nodeCount);
+
+    std::vector<std::atomic<int>> visits(nodeCount);
+    std::atomic<bool> depthOk{true};
+    bool completed = tree->parallelVisit(manager.getTaskExecutor(), [&](SceneNode& node, size_t depth) {
+        visits[node.getId().raw()].fetch_add(1);
+        if (node.getName() == "Leaf" && depth != 2) depthOk = false;
+        return VisitResult::Continue;
+    });
+    EXPECT_TRUE(completed);
+    EXPECT_TRUE(depthOk);
+    for (unsigned int id = 0; id < nodeCount; ++id) {
+        EXPECT_EQ(visits[id].load(), 1) << "node " << id;
+    }
+
+    // Pruning at the shared node hides its leaf no matter which branch reached it first
+    std::atomic<int> sharedLeafVisits{0};
+    tree->parallelVisit(manager.getTaskExecutor(), [&](SceneNode& node, size_t) {
+        if (node.getName() == "SharedLeaf") sharedLeafVisits.fetch_add(1);
+        return node.getName() == "Shared" ? VisitResult::SkipChildren : VisitResult::Continue;
+    });
+    EXPECT_EQ(sharedLeafVisits.load(), 0);
+
+    std::atomic<int> visited{0};
+    completed = tree->parallelVisit(manager.getTaskExecutor(), [&](SceneNode&, size_t) {
+        return visited.fetch_add(1) >= 200 ? VisitResult::Stop : VisitResult::Continue;
+    });
+    EXPECT_FALSE(completed);
+    EXPECT_LT(visited.load(), static_cast<int>(nodeCount));
+
+    EXPECT_THROW(tree->parallelVisit(manager.getTaskExecutor(), [](SceneNode& node, size_t) -> VisitResult {
+        if (node.getName() == "SharedLeaf") throw std::runtime_error("script error");
+        return VisitResult::Continue;
+    }), std::runtime_error);
+}
@@ -1,5 +1,6 @@
 #include "gtest/gtest.h"
 #include "SceneTree/SceneNode.h"
+#include <algorithm>
 #include <stdexcept>
 
 TEST(SceneNodeTest, Creation) {
@@ -41,6 +42,101 @@ TEST(SceneNodeTest, DetectCycle) {
     EXPECT_THROW(nodeC->addChild(nodeA), std::runtime_error);
 }
 
+TEST(SceneNodeTest, DetectCycleThroughStackedDiamonds) {
+    // 64 stacked diamonds: walking every parent path would take 2^64 steps
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    std::shared_ptr<SceneNode> top = root;
+    unsigned int nextId = 2;
+    for (int level = 0; level < 64; ++level) {
+        auto left = std::make_shared<SceneNode>(nextId++, "Left");
+        auto right = std::make_shared<SceneNode>(nextId++, "Right");
+        auto join = std::make_shared<SceneNode>(nextId++, "Join");
+        top->addChild(left);
+        top->addChild(right);
+        left->addChild(join);
+        right->addChild(join);
+        top = join;
+    }
+
+    EXPECT_THROW(top->addChild(root), std::runtime_error);
+    auto unrelated = std::make_shared<SceneNode>(nextId++, "Unrelated");
+    unrelated->addChild(std::make_shared<SceneNode>(nextId++, "UnrelatedChild"));
+    EXPECT_NO_THROW(top->addChild(unrelated));
+
+    // A subtree built bottom-up and then linked high up keeps its ranks consistent
+    auto prefab = std::make_shared<SceneNode>(nextId++, "Prefab");
+    auto prefabChild = std::make_shared<SceneNode>(nextId++, "PrefabChild");
+    prefab->addChild(prefabChild);
+    top->addChild(prefab);
+    EXPECT_THROW(prefabChild->addChild(root), std::runtime_error);
+    EXPECT_NO_THROW(root->addChild(prefabChild));
+}
+
+TEST(SceneNodeTest, RanksFollowBottomUpAndTopDownBuilds) {
+    // A deep chain built bottom-up, as the loaders do: each new parent moves above its child
+    // instead of re-ranking the chain below it, which would make this quadratic
+    constexpr unsigned int kDepth = 10000;
+    auto bottom = std::make_shared<SceneNode>(1, "Bottom");
+    std::shared_ptr<SceneNode> top = bottom;
+    for (unsigned int id = 2; id <= kDepth; ++id) {
+        auto parent = std::make_shared<SceneNode>(id, "Link");
+        parent->addChild(top);
+        top = parent;
+    }
+    EXPECT_THROW(bottom->addChild(top), std::runtime_error);
+
+    // The same chain hung below an existing node, then extended top-down from its bottom
+    auto host = std::make_shared<SceneNode>(kDepth + 1, "Host");
+    auto hostParent = std::make_shared<SceneNode>(kDepth + 2, "HostParent");
+    hostParent->addChild(host);
+    host->addChild(top);
+    std::shared_ptr<SceneNode> leaf = bottom;
+    for (unsigned int id = kDepth + 3; id < kDepth + 1000; ++id) {
+        auto child = std::make_shared<SceneNode>(id, "Tail");
+        leaf->addChild(child);
+        leaf = child;
+    }
+    EXPECT_THROW(leaf->addChild(hostParent), std::runtime_error);
+    EXPECT_THROW(bottom->addChild(host), std::runtime_error);
+
+    // Moving a subtree back and forth lets ranks drift but never break
+    auto other = std::make_shared<SceneNode>(kDepth + 2000, "Other");
+    auto moved = std::make_shared<SceneNode>(kDepth + 2001, "Moved");
+    moved->addChild(std::make_shared<SceneNode>(kDepth + 2002, "MovedChild"));
+    for (int i = 0; i < 1000; ++i) {
+        leaf->addChild(moved);
+        leaf->removeChild(moved);
+        other->addChild(moved);
+        other->removeChild(moved);
+    }
+    leaf->addChild(moved);
+    EXPECT_THROW(moved->getChildren().front()->addChild(top), std::runtime_error);
+    EXPECT_NO_THROW(moved->getChildren().front()->addChild(other));
+}
+
+TEST(SceneNodeTest, AddChildrenBatch) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto parent = std::make_shared<SceneNode>(2, "Parent");
+    root->addChild(parent);
+
+    std::vector<std::shared_ptr<SceneNode>> batch;
+    for (unsigned int id = 10; id < 20; ++id) {
+        batch.push_back(std::make_shared<SceneNode>(id, "Child"));
+    }
+    parent->addChildren(batch);
+    ASSERT_EQ(parent->getChildren().size(), 10);
+    EXPECT_EQ(batch[3]->getParents().size(), 1);
+
+    // A single ancestor in the batch rejects the whole batch
+    std::vector<std::shared_ptr<SceneNode>> bad{std::make_shared<SceneNode>(30, "Fresh"), root};
+    EXPECT_THROW(batch[0]->addChildren(bad), std::runtime_error);
+    EXPECT_TRUE(batch[0]->getChildren().empty());
+    EXPECT_TRUE(bad[0]->getParents().empty());
+
+    std::vector<std::shared_ptr<SceneNode>> self{batch[0]};
+    EXPECT_THROW(batch[0]->addChildren(self), std::invalid_argument);
+}
+
 TEST(SceneNodeTest, MultiParent) {
     auto root = std::make_shared<SceneNode>(1, "Root");
     auto nodeA = std::make_shared<SceneNode>(2, "NodeA");
@@ -164,4 +260,107 @@ TEST(SceneNodeTest, DirtyFlagBitwiseOperations) {
     
     mask &= NodeProperty::Name;
     EXPECT_EQ(mask, NodeProperty::Name);
-}
\ No newline at end of file
+}
+
+TEST(SceneNodeTest, NamesAndTagsAreInterned) {
+    auto node = std::make_shared<SceneNode>(1, "Enemy");
+    auto other = std::make_shared<SceneNode>(2, StringAtom::intern("Enemy"));
+    EXPECT_EQ(node->getNameAtom(), other->getNameAtom());
+    EXPECT_EQ(&node->getName(), &other->getName()); // Same interned storage
+
+    node->addTag("Alive");
+    EXPECT_TRUE(node->hasTag(StringAtom::intern("Alive")));
+    EXPECT_FALSE(node->hasTag("Stunned"));
+
+    node->setName(StringAtom::intern("Boss"));
+    EXPECT_EQ(node->getName(), "Boss");
+    EXPECT_EQ(node->getCleanNameAtom(), StringAtom::intern("Enemy"));
+}
+
+TEST(SceneNodeTest, TraversalOrders) {
+    // Root -> A -> Shared
+    // Root -> B -> Shared -> Leaf
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto nodeA = std::make_shared<SceneNode>(2, "A");
+    auto nodeB = std::make_shared<SceneNode>(3, "B");
+    auto shared = std::make_shared<SceneNode>(4, "Shared");
+    auto leaf = std::make_shared<SceneNode>(5, "Leaf");
+    root->addChild(nodeA);
+    root->addChild(nodeB);
+    nodeA->addChild(shared);
+    nodeB->addChild(shared);
+    shared->addChild(leaf);
+
+    auto collect = [](auto range) {
+        std::vector<std::string> names;
+        for (SceneNode* node : range) names.push_back(node->getName());
+        return names;
+    };
+
+    using Names = std::vector<std::string>;
+    EXPECT_EQ(collect(root->preOrder()), (Names{"Root", "A", "Shared", "Leaf", "B"}));
+    EXPECT_EQ(collect(root->preOrder(VisitMode::AllPaths)),
+              (Names{"Root", "A", "Shared", "Leaf", "B", "Shared", "Leaf"}));
+    EXPECT_EQ(collect(root->postOrder()), (Names{"Leaf", "Shared", "A", "B", "Root"}));
+    EXPECT_EQ(collect(root->breadthFirst()), (Names{"Root", "A", "B", "Shared", "Leaf"}));
+
+    auto range = root->breadthFirst();
+    std::vector<size_t> depths;
+    for (auto it = range.begin(); it != range.end(); ++it) depths.push_back(it.depth());
+    EXPECT_EQ(depths, (std::vector<size_t>{0, 1, 1, 2, 3}));
+
+    // Shared subtrees are reported once by the name searches
+    EXPECT_EQ(root->findAllChildNodesByName("Leaf").size(), 1);
+    EXPECT_EQ(nodeB->findFirstChildNodeByName("Leaf"), leaf);
+}
+
+TEST(SceneNodeTest, VisitorPruneAndStop) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto pruned = std::make_shared<SceneNode>(2, "Pruned");
+    auto hidden = std::make_shared<SceneNode>(3, "Hidden");
+    auto last = std::make_shared<SceneNode>(4, "Last");
+    auto never = std::make_shared<SceneNode>(5, "Never");
+    root->addChild(pruned);
+    pruned->addChild(hidden);
+    root->addChild(last);
+    root->addChild(never);
+
+    std::vector<std::string> visited;
+    bool completed = visitNodes(root->preOrder(), [&](SceneNode& node, size_t) {
+        visited.push_back(node.getName());
+        if (node.getName() == "Pruned") return VisitResult::SkipChildren;
+        if (node.getName() == "Last") return VisitResult::Stop;
+        return VisitResult::Continue;
+    });
+    EXPECT_FALSE(completed);
+    EXPECT_EQ(visited, (std::vector<std::string>{"Root", "Pruned", "Last"}));
+
+    size_t maxDepth = 0;
+    EXPECT_TRUE(visitNodes(root->postOrder(), [&](SceneNode&, size_t depth) {
+        maxDepth = std::max(maxDepth, depth);
+    }));
+    EXPECT_EQ(maxDepth, 2);
+}
+
+TEST(SceneNodeTest, TraversalOfStackedDiamondsIsLinear) {
+    // 20 stacked diamonds have 2^20 root-to-bottom paths; visiting once must stay linear
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    std::shared_ptr<SceneNode> top = root;
+    unsigned int nextId = 2;
+    for (int level = 0; level < 20; ++level) {
+        auto left = std::make_shared<SceneNode>(nextId++, "Left");
+        auto right = std::make_shared<SceneNode>(nextId++, "Right");
+        auto join = std::make_shared<SceneNode>(nextId++, "Join");
+        top->addChild(left);
+        top->addChild(right);
+        left->addChild(join);
+        right->addChild(join);
+        top = join;
+    }
+
+    size_t count = 0;
+    for (SceneNode* node : root->preOrder()) { (void)node; ++count; }
+    EXPECT_EQ(count, 1 + 20 * 3);
+    EXPECT_EQ(root->findAllChildNodesByName("Join").size(), 20);
+    EXPECT_EQ(root->postOrder().begin().depth(), 2 * 20);
+}
@@ -3,6 +3,9 @@
 #include "SceneTree/SceneNode.h"
 #include "Scene.h"
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
 
 TEST(SceneTreeTest, FindNode) {
     auto root = std::make_shared<SceneNode>(1, "Root");
@@ -20,6 +23,30 @@ TEST(SceneTreeTest, FindNode) {
     EXPECT_EQ(notFound, nullptr);
 }
 
+TEST(SceneTreeTest, FindNodesBatch) {
+    Scene scene("Batch");
+    scene.addObject(1, "Root");
+    for (uint32_t id = 2; id <= 200; ++id) {
+        scene.addObject(id, "Node", ObjectStatus::Active, id / 2);
+    }
+    auto tree = SceneTree::createFromScene(scene);
+
+    // Longer than the prefetch distance, with misses mixed in
+    std::vector<ObjectId> ids;
+    for (uint32_t i = 0; i < 100; ++i) ids.push_back((i * 37) % 250 + 1);
+    std::vector<SceneNode*> out(ids.size(), reinterpret_cast<SceneNode*>(1));
+    tree->findNodes(ids, out);
+    for (size_t i = 0; i < ids.size(); ++i) {
+        EXPECT_EQ(out[i], tree->findNode(ids[i]));
+    }
+    EXPECT_EQ(out[0], tree->findNode(1));
+    EXPECT_EQ(std::count(out.begin(), out.end(), nullptr), 20);
+
+    std::vector<SceneNode*> shortOut(ids.size() - 1);
+    EXPECT_THROW(tree->findNodes(ids, shortOut), std::invalid_argument);
+    tree->findNodes(Span<const ObjectId>(), Span<SceneNode*>());
+}
+
 TEST(SceneTreeTest, AttachAndDetach) {
     // Tree A
     auto rootA = std::make_shared<SceneNode>(1, "RootA");
@@ -425,12 +452,12 @@ TEST(SceneTreeTest, PropertyListeners) {
     // 1. Test Global Listener (Status Change)
     bool globalStatusCalled = false;
     tree->addPropertyListener(NodeProperty::Status, 
-        [&](SceneNode* node, NodeProperty prop, const std::any& oldVal, const std::any& newVal) {
+        [&](SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal) {
             globalStatusCalled = true;
             EXPECT_EQ(node->getId(), 2);
             EXPECT_EQ(prop, NodeProperty::Status);
-            EXPECT_EQ(std::any_cast<ObjectStatus>(oldVal), ObjectStatus::Active);
-            EXPECT_EQ(std::any_cast<ObjectStatus>(newVal), ObjectStatus::Broken);
+            EXPECT_EQ(oldVal.get<ObjectStatus>(), ObjectStatus::Active);
+            EXPECT_EQ(newVal.get<ObjectStatus>(), ObjectStatus::Broken);
         });
 
     child->setStatus(ObjectStatus::Broken);
@@ -439,11 +466,11 @@ TEST(SceneTreeTest, PropertyListeners) {
     // 2. Test Node Specific Listener (Name Change)
     bool nodeNameCalled = false;
     tree->addNodePropertyListener(2, NodeProperty::Name, 
-        [&](SceneNode* node, NodeProperty prop, const std::any& oldVal, const std::any& newVal) {
+        [&](SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal) {
             nodeNameCalled = true;
             EXPECT_EQ(node->getId(), 2);
-            EXPECT_EQ(std::any_cast<std::string>(oldVal), "Child");
-            EXPECT_EQ(std::any_cast<std::string>(newVal), "NewName");
+            EXPECT_EQ(oldVal.get<StringAtom>().str(), "Child");
+            EXPECT_EQ(newVal.get<StringAtom>().str(), "NewName");
         });
 
     child->setName("NewName");
@@ -452,15 +479,163 @@ TEST(SceneTreeTest, PropertyListeners) {
     // 3. Test Tag Listener (TagAdded)
     bool tagAddedCalled = false;
     tree->addPropertyListener(NodeProperty::TagAdded,
-        [&](SceneNode* node, NodeProperty prop, const std::any& oldVal, const std::any& newVal) {
+        [&](SceneNode* node, NodeProperty prop, const PropertyValue& oldVal, const PropertyValue& newVal) {
             tagAddedCalled = true;
-            EXPECT_EQ(std::any_cast<std::string>(newVal), "Enemy");
+            EXPECT_EQ(newVal.get<StringAtom>(), StringAtom::intern("Enemy"));
         });
     
     child->addTag("Enemy");
     EXPECT_TRUE(tagAddedCalled);
 }
 
+TEST(SceneTreeTest, TypedPropertyListeners) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto child = std::make_shared<SceneNode>(2, "Child");
+    root->addChild(child);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    std::vector<std::pair<ObjectStatus, ObjectStatus>> statuses;
+    tree->addPropertyListener<NodeProperty::Status>([&](SceneNode*, ObjectStatus oldStatus, ObjectStatus newStatus) {
+        statuses.emplace_back(oldStatus, newStatus);
+    });
+    std::vector<StringAtom> removedTags;
+    tree->addNodePropertyListener<NodeProperty::TagRemoved>(2, [&](SceneNode*, StringAtom oldTag, StringAtom newTag) {
+        removedTags.push_back(oldTag);
+        EXPECT_FALSE(newTag.isValid()); // No new value for a removal
+    });
+    std::vector<ObjectId> linked;
+    tree->addPropertyListener<NodeProperty::Hierarchy>([&](SceneNode*, ObjectId, ObjectId childId) {
+        linked.push_back(childId);
+    });
+
+    child->setStatus(ObjectStatus::Hidden);
+    child->addTag("Enemy");
+    child->removeTag("Enemy");
+    root->addChild(std::make_shared<SceneNode>(3, "Late"));
+
+    ASSERT_EQ(statuses.size(), 1);
+    EXPECT_EQ(statuses[0].first, ObjectStatus::Active);
+    EXPECT_EQ(statuses[0].second, ObjectStatus::Hidden);
+    ASSERT_EQ(removedTags.size(), 1);
+    EXPECT_EQ(removedTags[0].str(), "Enemy");
+    ASSERT_EQ(linked.size(), 1);
+    EXPECT_EQ(linked[0], 3);
+
+    // Payloads are small fixed-size values
+    PropertyValue none;
+    EXPECT_FALSE(none.has_value());
+    EXPECT_EQ(PropertyValue(StringAtom::intern("Enemy")).type(), PropertyValue::Type::Atom);
+    EXPECT_EQ(PropertyValue(ObjectId(7)).get<ObjectId>(), 7);
+    EXPECT_EQ(PropertyValue(ObjectId(7)).get<StringAtom>(), StringAtom::invalid());
+    EXPECT_LE(sizeof(PropertyValue), 8u);
+}
+
+TEST(SceneTreeTest, ListenerSubscriptions) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto child = std::make_shared<SceneNode>(2, "Child");
+    root->addChild(child);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    int globalCalls = 0;
+    int nodeCalls = 0;
+    {
+        auto globalSub = tree->subscribe(NodeProperty::Status, [&](SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&) {
+            globalCalls++;
+        });
+        auto nodeSub = tree->subscribe<NodeProperty::Status>(2, [&](SceneNode*, ObjectStatus, ObjectStatus) { nodeCalls++; });
+        EXPECT_TRUE(globalSub.isActive());
+        child->setStatus(ObjectStatus::Hidden);
+        EXPECT_EQ(globalCalls, 1);
+        EXPECT_EQ(nodeCalls, 1);
+
+        nodeSub.reset();
+        EXPECT_FALSE(nodeSub.isActive());
+        child->setStatus(ObjectStatus::Active);
+        EXPECT_EQ(globalCalls, 2);
+        EXPECT_EQ(nodeCalls, 1);
+    }
+    child->setStatus(ObjectStatus::Broken);
+    EXPECT_EQ(globalCalls, 2);
+
+    // Handles remove exactly once
+    ListenerHandle handle = tree->addPropertyListener(NodeProperty::Status, [&](SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&) {
+        globalCalls++;
+    });
+    EXPECT_TRUE(tree->removePropertyListener(handle));
+    EXPECT_FALSE(tree->removePropertyListener(handle));
+    child->setStatus(ObjectStatus::Active);
+    EXPECT_EQ(globalCalls, 2);
+
+    // A subscription may outlive its tree
+    auto late = tree->subscribe(NodeProperty::Name, [](SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&) {});
+    tree.reset();
+    EXPECT_FALSE(late.isActive());
+}
+
+TEST(SceneTreeTest, ListenersRemovedDuringDispatch) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto child = std::make_shared<SceneNode>(2, "Child");
+    root->addChild(child);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    // The first listener removes itself and the second one; neither runs again
+    int firstCalls = 0;
+    int secondCalls = 0;
+    int thirdCalls = 0;
+    ListenerHandle first;
+    ListenerHandle second;
+    first = tree->addPropertyListener(NodeProperty::TagAdded, [&](SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&) {
+        firstCalls++;
+        tree->removePropertyListener(first);
+        tree->removePropertyListener(second);
+        // Added during the dispatch: first called by the next event
+        tree->addPropertyListener(NodeProperty::TagAdded, [&](SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&) {
+            thirdCalls++;
+        });
+    });
+    second = tree->addPropertyListener(NodeProperty::TagAdded, [&](SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&) {
+        secondCalls++;
+    });
+
+    child->addTag("A");
+    EXPECT_EQ(firstCalls, 1);
+    EXPECT_EQ(secondCalls, 0);
+    EXPECT_EQ(thirdCalls, 0);
+    child->addTag("B");
+    EXPECT_EQ(firstCalls, 1);
+    EXPECT_EQ(thirdCalls, 1);
+}
+
+TEST(SceneTreeTest, DetachDropsNodeListeners) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto child = std::make_shared<SceneNode>(2, "Child");
+    auto grandChild = std::make_shared<SceneNode>(3, "GrandChild");
+    root->addChild(child);
+    child->addChild(grandChild);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    int calls = 0;
+    auto sub = tree->subscribe(3, NodeProperty::Name, [&](SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&) {
+        calls++;
+    });
+    tree->addNodePropertyListener(1, NodeProperty::Name, [&](SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&) {
+        calls++;
+    });
+    grandChild->setName("G1");
+    EXPECT_EQ(calls, 1);
+
+    auto detached = tree->detach(root.get(), child.get());
+    ASSERT_NE(detached, nullptr);
+    EXPECT_FALSE(sub.isActive());
+
+    // Attaching it back does not bring the listener back
+    tree->attach(root.get(), std::move(detached));
+    grandChild->setName("G2");
+    EXPECT_EQ(calls, 1);
+    root->setName("Root2");
+    EXPECT_EQ(calls, 2);
+}
+
 TEST(SceneTreeTest, TagLookupDynamic) {
     auto root = std::make_shared<SceneNode>(1, "Root");
     auto child = std::make_shared<SceneNode>(2, "Child");
@@ -535,4 +710,1095 @@ TEST(SceneTreeTest, BatchingMultipleUpdates) {
     EXPECT_NE(tree->findNodeByName("FinalName"), nullptr);
     EXPECT_EQ(tree->findNodeByName("Root"), nullptr);
     EXPECT_EQ(tree->findNodeByName("Name1"), nullptr);
-}
\ No newline at end of file
+}
+
+TEST(SceneTreeTest, BudgetedProcessEvents) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    std::vector<std::shared_ptr<SceneNode>> lights;
+    for (int i = 0; i < 100; ++i) {
+        lights.push_back(std::make_shared<SceneNode>(10 + i, "Light"));
+        root->addChild(lights.back());
+    }
+    auto tree = std::make_unique<SceneTree>(root);
+    tree->setBatchingEnabled(true);
+
+    std::vector<ObjectId> order;
+    tree->addPropertyListener(NodeProperty::Status, [&](SceneNode* node, NodeProperty, const PropertyValue&, const PropertyValue&) {
+        order.push_back(node->getId());
+    });
+    tree->addPropertyListener(NodeProperty::TagAdded, [&](SceneNode* node, NodeProperty, const PropertyValue&, const PropertyValue&) {
+        order.push_back(node->getId());
+    });
+
+    for (auto& light : lights) light->setStatus(ObjectStatus::Inactive);
+    lights[0]->addTag("Off");
+    EXPECT_EQ(tree->pendingEventCount(), 101);
+
+    // Three frames of 40 items each; the last one finishes early. Dirty nodes and queued
+    // events take turns, so the tag is applied in the first frame despite 100 dirty nodes.
+    EXPECT_EQ(tree->processEvents({40}), 40);
+    EXPECT_EQ(tree->pendingEventCount(), 61);
+    EXPECT_EQ(tree->findFirstNodeByTag("Off"), lights[0]);
+    EXPECT_EQ(tree->processEvents({40}), 40);
+    // Changes made between frames are served at the next event turn
+    lights[1]->addTag("Late");
+    EXPECT_EQ(tree->pendingEventCount(), 22);
+    EXPECT_EQ(tree->processEvents({40}), 22);
+    EXPECT_EQ(tree->pendingEventCount(), 0);
+
+    // Frame 1: status 10, tag 10, status 11..48. Frame 2: status 49..88 (no events left).
+    // Frame 3 starts with the event turn: tag 11, then status 89..109.
+    std::vector<ObjectId> expected{ObjectId(10), ObjectId(10)};
+    for (unsigned int id = 11; id <= 88; ++id) expected.push_back(id);
+    expected.push_back(11);
+    for (unsigned int id = 89; id <= 109; ++id) expected.push_back(id);
+    EXPECT_EQ(order, expected);
+
+    // A generous time budget drains everything
+    for (auto& light : lights) light->setStatus(ObjectStatus::Active);
+    EXPECT_EQ(tree->processEvents({0, std::chrono::seconds(10)}), 100);
+    EXPECT_EQ(tree->pendingEventCount(), 0);
+    EXPECT_EQ(tree->processEvents({1}), 0);
+}
+
+TEST(SceneTreeTest, CreateFromSceneUsesNodePool) {
+    Scene scene("PooledScene");
+    scene.addObject(1, "Root");
+    for (unsigned int i = 2; i <= 100; ++i) {
+        scene.addObject(i, "Crate", ObjectStatus::Active, 1);
+    }
+
+    auto tree = SceneTree::createFromScene(scene);
+    ASSERT_NE(tree, nullptr);
+
+    auto pool = tree->getNodePool();
+    ASSERT_NE(pool, nullptr);
+    EXPECT_EQ(pool->liveCount(), 100);
+    EXPECT_EQ(pool->pageCount(), 1); // Reserved up front from the scene size
+
+    // Lookups and children still refer to the pooled nodes
+    SceneNode* crate = tree->findNode(50);
+    ASSERT_NE(crate, nullptr);
+    EXPECT_EQ(tree->getRoot()->getChildren().size(), 99);
+    EXPECT_EQ(tree->getRoot()->getChildren()[48].get(), crate);
+
+    tree.reset();
+    EXPECT_EQ(pool->liveCount(), 0);
+}
+
+TEST(SceneTreeTest, PooledNodeOutlivesTree) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto tree = std::make_unique<SceneTree>(root);
+
+    auto pooled = tree->createNode(2, "Pooled");
+    auto pool = tree->getNodePool();
+    ASSERT_NE(pool, nullptr);
+    EXPECT_EQ(pool->liveCount(), 1);
+
+    auto wrapper = std::make_unique<SceneTree>(pooled);
+    ASSERT_TRUE(tree->attach(root.get(), std::move(wrapper)));
+    EXPECT_EQ(tree->findNode(2), pooled.get());
+
+    // Destroying the tree must not invalidate a node that is still referenced elsewhere
+    tree.reset();
+    EXPECT_EQ(pooled->getName(), "Pooled");
+    EXPECT_EQ(pool->liveCount(), 1);
+
+    root->removeChild(pooled);
+    pooled.reset();
+    EXPECT_EQ(pool->liveCount(), 0);
+}
+
+TEST(SceneTreeTest, NodePoolRecyclesSlots) {
+    auto pool = std::make_shared<SceneNodePool>(4);
+    auto first = SceneNodePool::makeNode(pool, 1, "A");
+    SceneNode* firstAddress = first.get();
+    first.reset();
+
+    auto second = SceneNodePool::makeNode(pool, 2, "B");
+    EXPECT_EQ(second.get(), firstAddress);
+
+    std::vector<std::shared_ptr<SceneNode>> nodes;
+    for (unsigned int i = 3; i < 12; ++i) {
+        nodes.push_back(SceneNodePool::makeNode(pool, i, "N"));
+    }
+    EXPECT_EQ(pool->liveCount(), 10);
+    EXPECT_EQ(pool->pageCount(), 3);
+}
+
+TEST(SceneTreeTest, BulkTeardownReleasesPoolPages) {
+    Scene scene("BulkScene");
+    scene.addObject(1, "Root");
+    for (unsigned int i = 2; i <= 5000; ++i) {
+        // Mix of wide and deep: every node hangs below the node created 1 or 2 steps earlier
+        scene.addObject(i, "Node", ObjectStatus::Active, (i % 2 == 0) ? i - 1 : std::max(1u, i - 2));
+    }
+
+    auto tree = SceneTree::createFromScene(scene);
+    ASSERT_NE(tree, nullptr);
+    auto pool = tree->getNodePool();
+    ASSERT_EQ(pool->liveCount(), 5000);
+    EXPECT_GT(pool->pageCount(), 0);
+
+    tree.reset();
+
+    // Every node was exclusively owned, so the pool dropped its pages wholesale
+    EXPECT_EQ(pool->liveCount(), 0);
+    EXPECT_EQ(pool->pageCount(), 0);
+}
+
+TEST(SceneTreeTest, TeardownKeepsNodesSharedWithAnotherTree) {
+    Scene scene("Owner");
+    scene.addObject(1, "Root");
+    scene.addObject(2, "Prop", ObjectStatus::Active, 1);
+    scene.addObject(3, "PropChild", ObjectStatus::Active, 2);
+    scene.addObject(4, "Scratch", ObjectStatus::Active, 1);
+    auto tree1 = SceneTree::createFromScene(scene);
+    ASSERT_NE(tree1, nullptr);
+
+    auto root2 = std::make_shared<SceneNode>(10, "Root2");
+    auto tree2 = std::make_unique<SceneTree>(root2);
+    auto prop = tree1->findNode(2)->shared_from_this();
+    ASSERT_TRUE(tree2->attach(root2.get(), std::make_unique<SceneTree>(prop)));
+    prop.reset();
+
+    auto pool = tree1->getNodePool();
+    SceneNode* scratchAddress = tree1->findNode(4);
+    tree1.reset();
+
+    // The dead leaf's slot is reusable even though the pool kept its pages. (Root's slot is
+    // not free yet: Prop still holds a weak parent link into its control block.)
+    auto reused = SceneNodePool::makeNode(pool, 50, "Reused");
+    EXPECT_EQ(reused.get(), scratchAddress);
+    reused.reset();
+
+    // Root died with tree1, the shared Prop subtree survives in tree2
+    SceneNode* shared = tree2->findNode(2);
+    ASSERT_NE(shared, nullptr);
+    auto liveParents = std::count_if(shared->getParents().begin(), shared->getParents().end(),
+                                     [](const std::weak_ptr<SceneNode>& p) { return !p.expired(); });
+    EXPECT_EQ(liveParents, 1);
+    EXPECT_GT(pool->pageCount(), 0);
+
+    // The shared node no longer reports to the destroyed tree, but still reports to tree2
+    bool notified = false;
+    tree2->addPropertyListener(NodeProperty::Status,
+        [&](SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&) { notified = true; });
+    tree2->findNode(3)->setStatus(ObjectStatus::Hidden);
+    EXPECT_TRUE(notified);
+
+    tree2.reset();
+    root2.reset();
+    EXPECT_EQ(pool->liveCount(), 0);
+}
+
+TEST(SceneTreeTest, LookupByInternedAtom) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto crate1 = std::make_shared<SceneNode>(2, "Crate");
+    auto crate2 = std::make_shared<SceneNode>(3, "Crate");
+    root->addChild(crate1);
+    root->addChild(crate2);
+    crate2->addTag("Breakable");
+    auto tree = std::make_unique<SceneTree>(root);
+
+    StringAtom crate = StringAtom::intern("Crate");
+    StringAtom breakable = StringAtom::intern("Breakable");
+
+    // Repeated names share one atom
+    EXPECT_EQ(crate1->getNameAtom(), crate2->getNameAtom());
+    EXPECT_EQ(crate1->getNameAtom(), crate);
+
+    EXPECT_EQ(tree->findNodeByName(crate), crate1);
+    EXPECT_EQ(tree->findAllNodesByName(crate).size(), 2);
+    EXPECT_EQ(tree->findFirstChildNodeByName(crate), crate1);
+    EXPECT_EQ(tree->findAllNodesByName(root.get(), crate).size(), 2);
+    EXPECT_EQ(tree->findFirstNodeByTag(breakable), crate2);
+
+    // Names that were never interned cannot match and are not added to the table
+    size_t atomCount = StringAtomTable::instance().size();
+    EXPECT_EQ(tree->findNodeByName("NeverSeenBefore_7f3a"), nullptr);
+    EXPECT_EQ(tree->findAllNodesByTag("NeverSeenBefore_7f3a").size(), 0);
+    EXPECT_EQ(StringAtomTable::instance().size(), atomCount);
+    EXPECT_FALSE(StringAtom::find("NeverSeenBefore_7f3a").isValid());
+}
+
+TEST(SceneTreeTest, NonOwningLookups) {
+    // Root -> A -> Crate(2)
+    // Root -> Crate(3)
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto nodeA = std::make_shared<SceneNode>(4, "A");
+    auto crate1 = std::make_shared<SceneNode>(2, "Crate");
+    auto crate2 = std::make_shared<SceneNode>(3, "Crate");
+    root->addChild(nodeA);
+    nodeA->addChild(crate1);
+    root->addChild(crate2);
+    crate1->addTag("Breakable");
+    auto tree = std::make_unique<SceneTree>(root);
+
+    // Spans read the index buckets in place
+    NodeSpan crates = tree->nodesByName("Crate");
+    ASSERT_EQ(crates.size(), 2);
+    EXPECT_EQ(std::count(crates.begin(), crates.end(), crate1.get()), 1);
+    EXPECT_EQ(std::count(crates.begin(), crates.end(), crate2.get()), 1);
+    ASSERT_EQ(tree->nodesByTag("Breakable").size(), 1);
+    EXPECT_EQ(tree->nodesByTag("Breakable")[0], crate1.get());
+    EXPECT_TRUE(tree->nodesByName("NeverSeenBefore_51c2").empty());
+
+    // Buffers are cleared and refilled, without touching the shared_ptr refcounts
+    long refs = crate1.use_count();
+    std::vector<SceneNode*> out{root.get()};
+    tree->findAllNodesByName("Crate", out);
+    EXPECT_EQ(out.size(), 2);
+    tree->findAllNodesByTag(StringAtom::intern("Breakable"), out);
+    EXPECT_EQ(out, std::vector<SceneNode*>{crate1.get()});
+    tree->findAllNodesByName(nodeA.get(), "Crate", out);
+    EXPECT_EQ(out, std::vector<SceneNode*>{crate1.get()});
+    nodeA->findAllChildNodesByName("Crate", out);
+    EXPECT_EQ(out, std::vector<SceneNode*>{crate1.get()});
+    EXPECT_EQ(crate1.use_count(), refs);
+
+    size_t visited = 0;
+    tree->forEachNodeByName(root.get(), StringAtom::intern("Crate"), [&](SceneNode*) { ++visited; });
+    EXPECT_EQ(visited, 2);
+    tree->forEachNodeByName(crate2.get(), StringAtom::intern("Crate"), [&](SceneNode* node) {
+        EXPECT_EQ(node, crate2.get()); // The start node counts
+        ++visited;
+    });
+    EXPECT_EQ(visited, 3);
+}
+
+TEST(SceneTreeTest, BucketRemovalKeepsFirstByInsertionOrder) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    std::vector<std::shared_ptr<SceneNode>> props;
+    for (unsigned int i = 0; i < 6; ++i) {
+        auto prop = std::make_shared<SceneNode>(10 + i, "Prop");
+        prop->addTag("Prop");
+        root->addChild(prop);
+        props.push_back(prop);
+    }
+    auto tree = std::make_unique<SceneTree>(root);
+
+    // "First" is the oldest entry still indexed, whatever swap-removal did to the dense order
+    root->removeChild(props[0]);
+    EXPECT_EQ(tree->findNodeByName("Prop"), props[1]);
+    props[3]->removeTag("Prop");
+    props[1]->removeTag("Prop");
+    EXPECT_EQ(tree->findFirstNodeByTag("Prop"), props[2]);
+    props[2]->setName("Renamed");
+    EXPECT_EQ(tree->findNodeByName("Prop"), props[1]);
+    props[1]->setName("Renamed");
+    EXPECT_EQ(tree->findNodeByName("Renamed"), props[2]); // Renamed first
+    EXPECT_EQ(tree->findNodeByName(root.get(), "Prop"), props[3]);
+
+    auto tagged = tree->findAllNodesByTag("Prop");
+    ASSERT_EQ(tagged.size(), 3);
+    EXPECT_EQ(tagged[0], props[2]);
+    EXPECT_EQ(tagged[1], props[4]);
+    EXPECT_EQ(tagged[2], props[5]);
+    auto named = tree->findAllNodesByName("Prop");
+    ASSERT_EQ(named.size(), 3);
+    EXPECT_EQ(named[0], props[3]);
+
+    // Despawning a large tagged population one by one stays linear
+    auto level = std::make_shared<SceneNode>(100, "Level");
+    std::vector<std::shared_ptr<SceneNode>> groups;
+    for (unsigned int g = 0; g < 300; ++g) {
+        auto group = std::make_shared<SceneNode>(200 + g, "Group");
+        for (unsigned int i = 0; i < 100; ++i) {
+            auto prop = std::make_shared<SceneNode>(1000 + g * 100 + i, "Clutter");
+            prop->addTag("Clutter");
+            group->addChild(prop);
+        }
+        level->addChild(group);
+        groups.push_back(group);
+    }
+    tree->attach(root.get(), std::make_unique<SceneTree>(level));
+    EXPECT_EQ(tree->nodesByTag("Clutter").size(), 30000);
+    for (auto& group : groups) {
+        while (group->getChildren().size() > (group == groups.front() ? 1u : 0u)) {
+            group->removeChild(group->getChildren().back());
+        }
+    }
+    EXPECT_EQ(tree->findFirstNodeByTag("Clutter")->getId(), 1000);
+    EXPECT_EQ(tree->nodesByName("Clutter").size(), 1);
+}
+
+TEST(SceneTreeTest, FlatHashMapMatchesUnorderedMap) {
+    // Every key lands in one of four home slots, so probe runs are long and wrap around
+    struct ClusteredHash {
+        size_t operator()(uint32_t key) const { return key % 4; }
+    };
+    FlatHashMap<uint32_t, std::string, ClusteredHash> clustered;
+    FlatHashMap<uint32_t, std::string> spread;
+    std::unordered_map<uint32_t, std::string> expected;
+
+    uint32_t state = 12345;
+    auto next = [&state]() { return state = state * 1664525u + 1013904223u; };
+    for (int step = 0; step < 20000; ++step) {
+        uint32_t key = next() % 200;
+        if (next() % 3 == 0) {
+            size_t erased = expected.erase(key);
+            ASSERT_EQ(clustered.erase(key), erased);
+            ASSERT_EQ(spread.erase(key), erased);
+        } else {
+            std::string value = std::to_string(step);
+            expected[key] = value;
+            clustered[key] = value;
+            spread.try_emplace(key).first->second = value;
+        }
+        ASSERT_EQ(clustered.size(), expected.size());
+        ASSERT_EQ(spread.size(), expected.size());
+    }
+
+    for (uint32_t key = 0; key < 200; ++key) {
+        auto it = expected.find(key);
+        ASSERT_EQ(clustered.count(key), it != expected.end() ? 1u : 0u);
+        ASSERT_EQ(spread.count(key), it != expected.end() ? 1u : 0u);
+        if (it != expected.end()) {
+            EXPECT_EQ(clustered.at(key), it->second);
+            EXPECT_EQ(spread.find(key)->second, it->second);
+        }
+    }
+    size_t visited = 0;
+    for (const auto& [key, value] : spread) {
+        EXPECT_EQ(expected.at(key), value);
+        ++visited;
+    }
+    EXPECT_EQ(visited, expected.size());
+
+    // erase(iterator) hands back the next entry, so filtering in place skips nothing
+    for (auto it = clustered.begin(); it != clustered.end();) {
+        it = (it->first % 2 == 0) ? clustered.erase(it) : std::next(it);
+    }
+    for (const auto& [key, value] : expected) {
+        EXPECT_EQ(clustered.count(key), key % 2 == 0 ? 0u : 1u);
+    }
+
+    FlatHashMap<uint32_t, std::string> copy = spread;
+    spread.clear();
+    EXPECT_TRUE(spread.empty());
+    EXPECT_EQ(copy.size(), expected.size());
+}
+
+TEST(SceneTreeTest, MultiTagMaskQuery) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto grunt = std::make_shared<SceneNode>(2, "Grunt");
+    auto stunned = std::make_shared<SceneNode>(3, "StunnedGrunt");
+    auto corpse = std::make_shared<SceneNode>(4, "Corpse");
+    root->addChild(grunt);
+    root->addChild(stunned);
+    root->addChild(corpse);
+
+    grunt->addTag("Enemy");
+    grunt->addTag("Alive");
+    stunned->addTag("Enemy");
+    stunned->addTag("Alive");
+    corpse->addTag("Enemy");
+
+    auto tree = std::make_unique<SceneTree>(root);
+    stunned->addTag("Stunned"); // Added after construction, goes through the event path
+
+    auto query = tree->makeTagQuery({"Enemy", "Alive"}, {"Stunned"});
+    std::vector<SceneNode*> matches;
+    tree->findNodesByTags(query, matches);
+    ASSERT_EQ(matches.size(), 1);
+    EXPECT_EQ(matches[0], grunt.get());
+
+    // Masks follow tag removal
+    stunned->removeTag("Stunned");
+    tree->findNodesByTags(query, matches);
+    EXPECT_EQ(matches.size(), 2);
+
+    // Exclude-only query scans every node
+    auto notEnemies = tree->findNodesByTags(tree->makeTagQuery(std::vector<std::string>{}, {"Enemy"}));
+    ASSERT_EQ(notEnemies.size(), 1);
+    EXPECT_EQ(notEnemies[0], root.get());
+
+    // A tag no node has ever carried cannot be included
+    EXPECT_TRUE(tree->makeTagQuery({"Enemy", "Flying"}).unsatisfiable);
+    EXPECT_TRUE(tree->findNodesByTags(tree->makeTagQuery({"Enemy", "Flying"})).empty());
+
+    // Detached nodes leave the dense arrays
+    auto detached = tree->detach(root.get(), grunt.get());
+    tree->findNodesByTags(query, matches);
+    ASSERT_EQ(matches.size(), 1);
+    EXPECT_EQ(matches[0], stunned.get());
+    EXPECT_EQ(detached->findNodesByTags(detached->makeTagQuery({"Enemy", "Alive"})).size(), 1);
+}
+
+TEST(SceneTreeTest, TagQueryBeyondMaskWidth) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto tree = std::make_unique<SceneTree>(root);
+    for (uint32_t i = 0; i < TagMask::kBits; ++i) {
+        root->addTag("Filler" + std::to_string(i));
+    }
+    auto child = tree->createNode(2, "Child");
+    child->addTag("Overflow");
+    ASSERT_TRUE(tree->attach(root.get(), std::make_unique<SceneTree>(child)));
+    EXPECT_EQ(tree->getTagRegistry().bitFor(StringAtom::intern("Overflow")), TagRegistry::kNoBit);
+
+    auto matches = tree->findNodesByTags(tree->makeTagQuery({"Overflow"}));
+    ASSERT_EQ(matches.size(), 1);
+    EXPECT_EQ(matches[0], child.get());
+    EXPECT_EQ(tree->findNodesByTags(tree->makeTagQuery({"Filler3"}, {"Overflow"})).size(), 1);
+}
+
+TEST(SceneTreeTest, IsAncestorOfWithSharedSubtrees) {
+    // Root -> A -> Shared -> Leaf
+    // Root -> B -> Shared
+    // Root -> C
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto nodeA = std::make_shared<SceneNode>(2, "A");
+    auto nodeB = std::make_shared<SceneNode>(3, "B");
+    auto nodeC = std::make_shared<SceneNode>(4, "C");
+    auto shared = std::make_shared<SceneNode>(5, "Shared");
+    auto leaf = std::make_shared<SceneNode>(6, "Leaf");
+    root->addChild(nodeA);
+    root->addChild(nodeB);
+    root->addChild(nodeC);
+    nodeA->addChild(shared);
+    nodeB->addChild(shared);
+    shared->addChild(leaf);
+
+    auto tree = std::make_unique<SceneTree>(root);
+
+    EXPECT_TRUE(tree->isAncestorOf(root.get(), leaf.get()));
+    EXPECT_TRUE(tree->isAncestorOf(nodeA.get(), leaf.get()));
+    EXPECT_TRUE(tree->isAncestorOf(nodeB.get(), leaf.get())); // Through the second parent
+    EXPECT_TRUE(tree->isAncestorOf(nodeB.get(), shared.get()));
+    EXPECT_FALSE(tree->isAncestorOf(nodeC.get(), leaf.get()));
+    EXPECT_FALSE(tree->isAncestorOf(leaf.get(), nodeB.get()));
+    EXPECT_FALSE(tree->isAncestorOf(nodeA.get(), nodeB.get()));
+
+    // Scoped lookups go through the labeling
+    EXPECT_EQ(tree->findNodeByName(nodeB.get(), "Leaf"), leaf);
+    EXPECT_EQ(tree->findNodeByName(nodeC.get(), "Leaf"), nullptr);
+
+    // Labels follow structural changes made directly on nodes
+    nodeC->addChild(shared);
+    EXPECT_TRUE(tree->isAncestorOf(nodeC.get(), leaf.get()));
+    EXPECT_EQ(tree->findAllNodesByName(nodeC.get(), "Leaf").size(), 1);
+
+    nodeB->removeChild(shared);
+    EXPECT_FALSE(tree->isAncestorOf(nodeB.get(), leaf.get()));
+    EXPECT_TRUE(tree->isAncestorOf(nodeA.get(), leaf.get()));
+
+    // Concurrent readers after a change share a single rebuild of the labeling
+    nodeB->addChild(shared);
+    std::atomic<int> hits{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]() {
+            for (int i = 0; i < 1000; ++i) {
+                if (tree->isAncestorOf(nodeB.get(), leaf.get()) && !tree->isAncestorOf(leaf.get(), root.get())) ++hits;
+            }
+        });
+    }
+    for (auto& reader : readers) reader.join();
+    EXPECT_EQ(hits.load(), 4000);
+}
+
+TEST(SceneTreeTest, EffectiveStatePropagatesDownSubtrees) {
+    // Root -> A -> A1 -> A2
+    // Root -> B
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto nodeA = std::make_shared<SceneNode>(2, "A");
+    auto nodeA1 = std::make_shared<SceneNode>(3, "A1");
+    auto nodeA2 = std::make_shared<SceneNode>(4, "A2");
+    auto nodeB = std::make_shared<SceneNode>(5, "B");
+    root->addChild(nodeA);
+    root->addChild(nodeB);
+    nodeA->addChild(nodeA1);
+    nodeA1->addChild(nodeA2);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    std::vector<SceneNode*> visible;
+    tree->findEffectivelyVisibleNodes(visible);
+    EXPECT_EQ(visible.size(), 5);
+    EXPECT_TRUE(tree->isEffectivelyActive(nodeA2.get()));
+
+    // Hiding a node hides its subtree; its own flag stays with the node
+    nodeA->setVisible(false);
+    EXPECT_FALSE(tree->isEffectivelyVisible(nodeA.get()));
+    EXPECT_FALSE(tree->isEffectivelyVisible(nodeA2.get()));
+    EXPECT_TRUE(nodeA2->isVisible());
+    EXPECT_TRUE(tree->isEffectivelyActive(nodeA2.get()));
+    tree->findEffectivelyVisibleNodes(visible);
+    EXPECT_EQ(visible.size(), 2);
+
+    // Status: Inactive deactivates the subtree, Hidden also hides it
+    nodeA->setVisible(true);
+    nodeA1->setStatus(ObjectStatus::Inactive);
+    EXPECT_TRUE(tree->isEffectivelyVisible(nodeA2.get()));
+    EXPECT_FALSE(tree->isEffectivelyActive(nodeA2.get()));
+    EXPECT_TRUE(tree->isEffectivelyActive(nodeA.get()));
+    nodeA1->setStatus(ObjectStatus::Hidden);
+    EXPECT_FALSE(tree->isEffectivelyVisible(nodeA2.get()));
+
+    // Moving a node under a hidden parent
+    nodeA1->setStatus(ObjectStatus::Active);
+    nodeB->setVisible(false);
+    nodeA->removeChild(nodeA1);
+    nodeB->addChild(nodeA1);
+    EXPECT_FALSE(tree->isEffectivelyVisible(nodeA2.get()));
+    EXPECT_TRUE(tree->isEffectivelyVisible(nodeA.get()));
+
+    // Nodes outside the tree are neither
+    auto outside = std::make_shared<SceneNode>(9, "Outside");
+    EXPECT_FALSE(tree->isEffectivelyVisible(outside.get()));
+    EXPECT_FALSE(tree->isEffectivelyActive(outside.get()));
+}
+
+TEST(SceneTreeTest, EffectiveStateOnSharedNodes) {
+    // Root -> A -> Shared -> Leaf
+    // Root -> B -> Shared
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto nodeA = std::make_shared<SceneNode>(2, "A");
+    auto nodeB = std::make_shared<SceneNode>(3, "B");
+    auto shared = std::make_shared<SceneNode>(4, "Shared");
+    auto leaf = std::make_shared<SceneNode>(5, "Leaf");
+    root->addChild(nodeA);
+    root->addChild(nodeB);
+    nodeA->addChild(shared);
+    nodeB->addChild(shared);
+    shared->addChild(leaf);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    // Every parent has to be visible
+    nodeB->setVisible(false);
+    EXPECT_FALSE(tree->isEffectivelyVisible(shared.get()));
+    EXPECT_FALSE(tree->isEffectivelyVisible(leaf.get()));
+
+    // Cutting the hidden edge makes the shared part visible again
+    nodeB->removeChild(shared);
+    EXPECT_TRUE(tree->isEffectivelyVisible(leaf.get()));
+
+    // Changes are picked up when they are processed
+    tree->setBatchingEnabled(true);
+    nodeA->setStatus(ObjectStatus::Inactive);
+    EXPECT_TRUE(tree->isEffectivelyActive(leaf.get()));
+    tree->processEvents();
+    EXPECT_FALSE(tree->isEffectivelyActive(leaf.get()));
+
+    // Visibility changes are events like any other property
+    int events = 0;
+    tree->addPropertyListener<NodeProperty::Visibility>([&](SceneNode* node, bool oldVal, bool newVal) {
+        EXPECT_EQ(node, leaf.get());
+        EXPECT_TRUE(oldVal);
+        EXPECT_FALSE(newVal);
+        ++events;
+    });
+    leaf->setVisible(false);
+    tree->processEvents();
+    EXPECT_EQ(events, 1);
+    std::vector<SceneNode*> visible;
+    tree->findEffectivelyVisibleNodes(visible);
+    EXPECT_EQ(visible.size(), 3); // Root, A and Shared
+    std::vector<SceneNode*> active;
+    tree->findEffectivelyActiveNodes(active);
+    EXPECT_EQ(active.size(), 2);
+}
+
+TEST(SceneTreeTest, LiveQueryTracksTagsAndStatus) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto enemyA = std::make_shared<SceneNode>(2, "EnemyA");
+    auto enemyB = std::make_shared<SceneNode>(3, "EnemyB");
+    auto crate = std::make_shared<SceneNode>(4, "Crate");
+    enemyA->addTag("Enemy");
+    enemyB->addTag("Enemy");
+    enemyB->addTag("Stunned");
+    root->addChild(enemyA);
+    root->addChild(enemyB);
+    root->addChild(crate);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    LiveQuerySpec spec;
+    spec.include = {StringAtom::intern("Enemy")};
+    spec.exclude = {StringAtom::intern("Stunned")};
+    spec.statuses = statusBit(ObjectStatus::Active);
+    auto enemies = tree->createLiveQuery(spec);
+    ASSERT_EQ(enemies->size(), 1);
+    EXPECT_EQ(enemies->nodes()[0], enemyA.get());
+
+    // Tags, statuses and new nodes are picked up as their events are delivered
+    enemyB->removeTag("Stunned");
+    crate->addTag("Enemy");
+    enemyA->setStatus(ObjectStatus::Inactive);
+    EXPECT_FALSE(enemies->contains(enemyA.get()));
+    EXPECT_TRUE(enemies->contains(enemyB.get()));
+    EXPECT_TRUE(enemies->contains(crate.get()));
+    EXPECT_EQ(enemies->size(), 2);
+
+    auto spawned = std::make_shared<SceneNode>(5, "Spawned");
+    spawned->addTag("Enemy");
+    tree->attach(crate.get(), std::make_unique<SceneTree>(spawned));
+    EXPECT_TRUE(enemies->contains(spawned.get()));
+
+    // Nodes leave the query with the tree
+    root->removeChild(crate);
+    EXPECT_FALSE(enemies->contains(crate.get()));
+    EXPECT_FALSE(enemies->contains(spawned.get()));
+    std::vector<SceneNode*> members(enemies->nodes().begin(), enemies->nodes().end());
+    EXPECT_EQ(members, std::vector<SceneNode*>{enemyB.get()});
+
+    // Batched events are applied when processed
+    tree->setBatchingEnabled(true);
+    enemyA->setStatus(ObjectStatus::Active);
+    EXPECT_EQ(enemies->size(), 1);
+    tree->processEvents();
+    EXPECT_EQ(enemies->size(), 2);
+
+    // A query that is no longer held is dropped; one that outlives the tree is empty
+    auto all = tree->createLiveQuery({});
+    EXPECT_EQ(all->size(), 3);
+    tree.reset();
+    EXPECT_TRUE(enemies->nodes().empty());
+    EXPECT_FALSE(all->contains(root.get()));
+}
+
+TEST(SceneTreeTest, LiveQueryScopedToSubtree) {
+    // Root -> A -> Shared -> Leaf
+    // Root -> B -> Shared
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto nodeA = std::make_shared<SceneNode>(2, "A");
+    auto nodeB = std::make_shared<SceneNode>(3, "B");
+    auto shared = std::make_shared<SceneNode>(4, "Shared");
+    auto leaf = std::make_shared<SceneNode>(5, "Leaf");
+    root->addChild(nodeA);
+    root->addChild(nodeB);
+    nodeA->addChild(shared);
+    nodeB->addChild(shared);
+    shared->addChild(leaf);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    LiveQuerySpec spec;
+    spec.scope = nodeB->getId();
+    auto underB = tree->createLiveQuery(spec);
+    EXPECT_EQ(underB->size(), 3); // B, Shared, Leaf
+
+    // Cutting the edge into the scope re-checks the subtree below it
+    nodeB->removeChild(shared);
+    EXPECT_EQ(underB->size(), 1);
+    EXPECT_TRUE(underB->contains(nodeB.get()));
+
+    auto extra = std::make_shared<SceneNode>(6, "Extra");
+    extra->addChild(leaf);
+    tree->attach(nodeB.get(), std::make_unique<SceneTree>(extra));
+    EXPECT_EQ(underB->size(), 3); // B, Extra, Leaf
+    EXPECT_TRUE(underB->contains(leaf.get()));
+
+    // The scope node itself leaving empties the query
+    root->removeChild(nodeB);
+    EXPECT_TRUE(underB->nodes().empty());
+    EXPECT_NE(tree->findNode(5), nullptr); // Leaf is still held by Shared
+}
+
+TEST(SceneTreeTest, ScopedLookupOnStackedDiamonds) {
+    // A chain of diamonds: every level has two nodes that both point at the next level's top.
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    std::shared_ptr<SceneNode> top = root;
+    unsigned int nextId = 2;
+    std::vector<std::shared_ptr<SceneNode>> lefts;
+    for (int level = 0; level < 16; ++level) {
+        auto left = std::make_shared<SceneNode>(nextId++, "Left");
+        auto right = std::make_shared<SceneNode>(nextId++, "Right");
+        auto join = std::make_shared<SceneNode>(nextId++, "Join");
+        top->addChild(left);
+        top->addChild(right);
+        left->addChild(join);
+        right->addChild(join);
+        lefts.push_back(left);
+        top = join;
+    }
+    auto bottom = std::make_shared<SceneNode>(nextId++, "Bottom");
+    top->addChild(bottom);
+
+    auto tree = std::make_unique<SceneTree>(root);
+
+    // Every Join below a given level is reachable, through left or right
+    SceneNode* right10 = tree->findNode(2 + 10 * 3 + 1);
+    ASSERT_NE(right10, nullptr);
+    EXPECT_EQ(right10->getName(), "Right");
+    EXPECT_TRUE(tree->isAncestorOf(right10, bottom.get()));
+    EXPECT_FALSE(tree->isAncestorOf(right10, lefts[10].get()));
+    EXPECT_EQ(tree->findNodeByName(right10, "Bottom"), bottom);
+}
+
+TEST(SceneTreeTest, LinearOrderIsTopological) {
+    // Root -> A -> Shared -> Leaf
+    // Root -> B -> Shared
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto nodeA = std::make_shared<SceneNode>(2, "A");
+    auto nodeB = std::make_shared<SceneNode>(3, "B");
+    auto shared = std::make_shared<SceneNode>(4, "Shared");
+    auto leaf = std::make_shared<SceneNode>(5, "Leaf");
+    root->addChild(nodeA);
+    root->addChild(nodeB);
+    nodeA->addChild(shared);
+    nodeB->addChild(shared);
+    shared->addChild(leaf);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    const auto& order = tree->getLinearOrder();
+    ASSERT_EQ(order.size(), 5);
+    std::vector<std::string> names;
+    for (const auto& entry : order) names.push_back(entry.node->getName());
+    // Shared waits for its second parent
+    EXPECT_EQ(names, (std::vector<std::string>{"Root", "A", "B", "Shared", "Leaf"}));
+    EXPECT_EQ(order[0].parent, SceneTree::LinearNode::kNoParent);
+    EXPECT_EQ(order[3].parent, 2); // Last parent, B
+    EXPECT_EQ(order[3].depth, 2);
+    EXPECT_EQ(order[4].parent, 3);
+    EXPECT_EQ(order[4].depth, 3);
+
+    // Direct structural edits are picked up on the next call
+    auto extra = std::make_shared<SceneNode>(6, "Extra");
+    auto subtree = std::make_unique<SceneTree>(extra);
+    tree->attach(leaf.get(), std::move(subtree));
+    nodeA->removeChild(shared);
+    const auto& rebuilt = tree->getLinearOrder();
+    ASSERT_EQ(rebuilt.size(), 6);
+    EXPECT_EQ(rebuilt[3].node, shared.get());
+    EXPECT_EQ(rebuilt[3].depth, 2);
+    EXPECT_EQ(rebuilt[5].node, extra.get());
+    EXPECT_EQ(rebuilt[5].depth, 4);
+}
+
+TEST(SceneTreeTest, LinearOrderFollowsAttachAndDetach) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto a = std::make_shared<SceneNode>(2, "A");
+    auto b = std::make_shared<SceneNode>(3, "B");
+    root->addChild(a);
+    root->addChild(b);
+    auto tree = std::make_unique<SceneTree>(root);
+    const auto& order = tree->getLinearOrder();
+    ASSERT_EQ(order.size(), 3);
+
+    // Attached subtree is appended after the existing nodes, pre-order inside
+    auto subRoot = std::make_shared<SceneNode>(10, "Sub");
+    auto subChild = std::make_shared<SceneNode>(11, "SubChild");
+    subRoot->addChild(subChild);
+    tree->attach(a.get(), std::make_unique<SceneTree>(subRoot));
+    ASSERT_EQ(order.size(), 5);
+    EXPECT_EQ(order[3].node, subRoot.get());
+    EXPECT_EQ(order[3].parent, 1);
+    EXPECT_EQ(order[3].depth, 2);
+    EXPECT_EQ(order[4].node, subChild.get());
+    EXPECT_EQ(order[4].parent, 3);
+
+    // Detach cuts nodes out and remaps the parent indices of those that follow
+    auto detached = tree->detach(root.get(), a.get());
+    ASSERT_NE(detached, nullptr);
+    ASSERT_EQ(order.size(), 2);
+    EXPECT_EQ(tree->getLinearOrder()[1].node, b.get());
+    EXPECT_EQ(tree->getLinearOrder()[1].parent, 0);
+
+    const auto& detachedOrder = detached->getLinearOrder();
+    ASSERT_EQ(detachedOrder.size(), 3);
+    EXPECT_EQ(detachedOrder[0].node, a.get());
+    EXPECT_EQ(detachedOrder[2].node, subChild.get());
+    EXPECT_EQ(detachedOrder[2].depth, 2);
+}
+
+TEST(SceneTreeTest, DetachMovesIndexEntries) {
+    // Root -> Group -> Enemy (tagged)
+    //               -> Shared
+    // Root -> Other -> Shared
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto group = std::make_shared<SceneNode>(2, "Group");
+    auto enemy = std::make_shared<SceneNode>(3, "Enemy");
+    auto other = std::make_shared<SceneNode>(4, "Other");
+    auto shared = std::make_shared<SceneNode>(5, "Shared");
+    enemy->addTag("Enemy");
+    root->addChild(group);
+    root->addChild(other);
+    group->addChild(enemy);
+    group->addChild(shared);
+    other->addChild(shared);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    int mainTreeNameEvents = 0;
+    tree->addPropertyListener(NodeProperty::Name, [&](SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&) {
+        ++mainTreeNameEvents;
+    });
+
+    auto detached = tree->detach(root.get(), group.get());
+    ASSERT_NE(detached, nullptr);
+
+    // Released nodes left the main tree; the shared node is indexed by both
+    EXPECT_EQ(tree->findNode(2), nullptr);
+    EXPECT_EQ(tree->findNode(3), nullptr);
+    EXPECT_EQ(tree->findNode(5), shared.get());
+    EXPECT_TRUE(tree->findAllNodesByTag("Enemy").empty());
+    EXPECT_EQ(detached->findNode(3), enemy.get());
+    EXPECT_EQ(detached->findNode(5), shared.get());
+    EXPECT_EQ(detached->findFirstNodeByTag("Enemy"), enemy);
+
+    // Moved nodes now report to the detached tree only
+    enemy->setName("Renamed");
+    EXPECT_EQ(mainTreeNameEvents, 0);
+    EXPECT_EQ(detached->findNodeByName("Renamed"), enemy);
+    EXPECT_EQ(tree->findNodeByName("Renamed"), nullptr);
+
+    // Re-attaching restores the original structure
+    ASSERT_TRUE(tree->attach(root.get(), std::move(detached)));
+    EXPECT_EQ(tree->findNode(3), enemy.get());
+    EXPECT_EQ(tree->findFirstNodeByTag("Enemy"), enemy);
+}
+
+TEST(SceneTreeTest, DirectRemoveChildReleasesUnreachableNodes) {
+    // Root -> A -> Leaf
+    // Root -> B -> Shared
+    // Root -> C -> Shared
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto nodeA = std::make_shared<SceneNode>(2, "A");
+    auto leaf = std::make_shared<SceneNode>(3, "Leaf");
+    auto nodeB = std::make_shared<SceneNode>(4, "B");
+    auto nodeC = std::make_shared<SceneNode>(5, "C");
+    auto shared = std::make_shared<SceneNode>(6, "Shared");
+    root->addChild(nodeA);
+    root->addChild(nodeB);
+    root->addChild(nodeC);
+    nodeA->addChild(leaf);
+    nodeB->addChild(shared);
+    nodeC->addChild(shared);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    // Still held by C
+    nodeB->removeChild(shared);
+    EXPECT_EQ(tree->findNode(6), shared.get());
+
+    // Last in-tree parent gone
+    nodeC->removeChild(shared);
+    EXPECT_EQ(tree->findNode(6), nullptr);
+    EXPECT_EQ(tree->findNodeByName("Shared"), nullptr);
+
+    root->removeChild(nodeA);
+    EXPECT_EQ(tree->findNode(2), nullptr);
+    EXPECT_EQ(tree->findNode(3), nullptr);
+    EXPECT_EQ(tree->getLinearOrder().size(), 3);
+
+    // No longer observed: changes do not reach the tree
+    leaf->setName("Moved");
+    EXPECT_EQ(tree->findNodeByName("Moved"), nullptr);
+}
+
+TEST(SceneTreeTest, BulkEditIndexesAtCommit) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto tree = std::make_unique<SceneTree>(root);
+    int hierarchyEvents = 0;
+    tree->addPropertyListener(NodeProperty::Hierarchy, [&](SceneNode*, NodeProperty, const PropertyValue&, const PropertyValue&) {
+        hierarchyEvents++;
+    });
+
+    const int count = 2000;
+    {
+        auto edit = tree->beginEdit();
+        EXPECT_TRUE(tree->isEditing());
+        for (int i = 0; i < count; ++i) {
+            auto enemy = std::make_shared<SceneNode>(100 + i, "Enemy");
+            enemy->addTag("Spawned");
+            auto weapon = std::make_shared<SceneNode>(100000 + i, "Weapon");
+            enemy->addChild(weapon);
+            EXPECT_TRUE(tree->attach(root.get(), std::make_unique<SceneTree>(enemy)));
+        }
+        // Attaching below a node attached in the same edit works as well
+        auto boss = std::make_shared<SceneNode>(50, "Boss");
+        EXPECT_TRUE(tree->attach(tree->getRoot()->getChildren()[0].get(), std::make_unique<SceneTree>(boss)));
+
+        // Not indexed yet
+        EXPECT_EQ(tree->findNode(100), nullptr);
+        EXPECT_EQ(hierarchyEvents, 0);
+    }
+    EXPECT_FALSE(tree->isEditing());
+
+    EXPECT_EQ(tree->findAllNodesByName("Enemy").size(), count);
+    EXPECT_EQ(tree->findAllNodesByName("Weapon").size(), count);
+    EXPECT_EQ(tree->findAllNodesByTag("Spawned").size(), count);
+    EXPECT_NE(tree->findNode(100000 + count - 1), nullptr);
+    EXPECT_NE(tree->findNode(50), nullptr);
+    EXPECT_TRUE(tree->isAncestorOf(tree->findNode(100), tree->findNode(50)));
+    EXPECT_EQ(tree->getLinearOrder().size(), 2 * count + 2);
+    EXPECT_EQ(hierarchyEvents, count); // The boss was linked below a node that was not indexed yet
+
+    // Nodes indexed at commit are observed from then on
+    tree->findNode(100)->setName("Renamed");
+    EXPECT_EQ(tree->findNodeByName("Renamed").get(), tree->findNode(100));
+}
+
+TEST(SceneTreeTest, BulkEditCoalescesNotifications) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto nodeA = std::make_shared<SceneNode>(2, "A");
+    auto nodeB = std::make_shared<SceneNode>(3, "B");
+    auto nodeC = std::make_shared<SceneNode>(4, "C");
+    root->addChild(nodeA);
+    root->addChild(nodeB);
+    root->addChild(nodeC);
+    nodeA->addTag("Old");
+    auto tree = std::make_unique<SceneTree>(root);
+
+    std::vector<std::pair<NodeProperty, ObjectId>> events;
+    auto record = [&](SceneNode* node, NodeProperty prop, const PropertyValue&, const PropertyValue&) {
+        events.emplace_back(prop, node->getId());
+    };
+    for (auto prop : {NodeProperty::Name, NodeProperty::Status, NodeProperty::TagAdded,
+                      NodeProperty::TagRemoved, NodeProperty::Hierarchy}) {
+        tree->addPropertyListener(prop, record);
+    }
+
+    {
+        auto edit = tree->beginEdit();
+        {
+            auto nested = tree->beginEdit();
+            nodeA->setName("A1");
+            nodeA->setName("A2");
+            nodeB->setName("Tmp");
+            nodeB->setName("B"); // Changed back: nothing to report
+        }
+        EXPECT_TRUE(tree->isEditing());
+        EXPECT_EQ(tree->findNodeByName("A").get(), nodeA.get());
+
+        nodeA->addTag("Transient");
+        nodeA->removeTag("Transient");
+        nodeA->removeTag("Old");
+        nodeB->addTag("New");
+        nodeC->setStatus(ObjectStatus::Inactive);
+
+        // Unlinked and linked again: the node stays, nothing to report
+        root->removeChild(nodeC);
+        root->addChild(nodeC);
+        EXPECT_TRUE(events.empty());
+        edit.commit();
+        EXPECT_FALSE(tree->isEditing());
+    }
+
+    ASSERT_EQ(events.size(), 4);
+    auto has = [&](NodeProperty prop, ObjectId id) {
+        return std::find(events.begin(), events.end(), std::make_pair(prop, id)) != events.end();
+    };
+    EXPECT_TRUE(has(NodeProperty::Name, 2));
+    EXPECT_TRUE(has(NodeProperty::Status, 4));
+    EXPECT_TRUE(has(NodeProperty::TagRemoved, 2));
+    EXPECT_TRUE(has(NodeProperty::TagAdded, 3));
+
+    EXPECT_EQ(tree->findNodeByName("A"), nullptr);
+    EXPECT_EQ(tree->findNodeByName("A2"), nodeA);
+    EXPECT_EQ(tree->findNodeByName("B"), nodeB);
+    EXPECT_EQ(tree->findNodeByName("Tmp"), nullptr);
+    EXPECT_EQ(tree->findFirstNodeByTag("Old"), nullptr);
+    EXPECT_EQ(tree->findFirstNodeByTag("Transient"), nullptr);
+    EXPECT_EQ(tree->findFirstNodeByTag("New"), nodeB);
+    EXPECT_EQ(tree->findNodesByTags(tree->makeTagQuery({"New"})).size(), 1);
+    EXPECT_EQ(tree->findNode(4), nodeC.get());
+}
+
+TEST(SceneTreeTest, BulkEditReleasesAndDetaches) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto nodeA = std::make_shared<SceneNode>(2, "A");
+    auto leaf = std::make_shared<SceneNode>(3, "Leaf");
+    auto nodeB = std::make_shared<SceneNode>(4, "B");
+    root->addChild(nodeA);
+    root->addChild(nodeB);
+    nodeA->addChild(leaf);
+    auto tree = std::make_unique<SceneTree>(root);
+
+    std::unique_ptr<SceneTree> detached;
+    {
+        auto edit = tree->beginEdit();
+        root->removeChild(nodeA);
+        EXPECT_EQ(tree->findNode(3), leaf.get()); // Released at commit
+
+        // detach() sees the renamed node in its new bucket and leaves nothing behind
+        nodeB->setName("B2");
+        nodeB->addTag("Gone");
+        detached = tree->detach(root.get(), nodeB.get());
+        ASSERT_NE(detached, nullptr);
+        EXPECT_EQ(detached->findNodeByName("B2"), nodeB);
+    }
+
+    EXPECT_EQ(tree->findNode(2), nullptr);
+    EXPECT_EQ(tree->findNode(3), nullptr);
+    EXPECT_EQ(tree->findNode(4), nullptr);
+    EXPECT_EQ(tree->findNodeByName("Leaf"), nullptr);
+    EXPECT_EQ(tree->findNodeByName("B"), nullptr);
+    EXPECT_EQ(tree->findNodeByName("B2"), nullptr);
+    EXPECT_EQ(tree->findFirstNodeByTag("Gone"), nullptr);
+    EXPECT_EQ(tree->getLinearOrder().size(), 1);
+}
+
+TEST(SceneTreeTest, ChangeJournalRecordsAppliedChanges) {
+    auto root = std::make_shared<SceneNode>(1, "Root");
+    auto child = std::make_shared<SceneNode>(2, "Child");
+    root->addChild(child);
+    auto tree = std::make_unique<SceneTree>(root);
+    EXPECT_EQ(tree->getChangeJournal(), nullptr);
+    tree->enableChangeJournal(6); // Rounded up to 8
+    auto journal = tree->getChangeJournal();
+    ASSERT_NE(journal, nullptr);
+    EXPECT_EQ(journal->capacity(), 8);
+
+    child->setName("Renamed");
+    child->addTag("Enemy");
+    auto sub = std::make_shared<SceneNode>(3, "Sub");
+    tree->attach(child.get(), std::make_unique<SceneTree>(sub));
+    tree->detach(child.get(), sub.get());
+
+    std::vector<ChangeRecord> records;
+    EXPECT_TRUE(journal->readSince(0, records));
+    ASSERT_EQ(records.size(), 6);
+    for (size_t i = 0; i < records.size(); ++i) EXPECT_EQ(records[i].sequence, i + 1);
+    EXPECT_EQ(records[0].property, NodeProperty::Name);
+    EXPECT_EQ(records[0].node, 2);
+    EXPECT_EQ(records[0].oldVal.get<StringAtom>().str(), "Child");
+    EXPECT_EQ(records[0].newVal.get<StringAtom>().str(), "Renamed");
+    EXPECT_EQ(records[1].property, NodeProperty::TagAdded);
+    EXPECT_EQ(records[1].newVal.get<StringAtom>().str(), "Enemy");
+    EXPECT_EQ(records[2].property, NodeProperty::Hierarchy); // The link made by attach
+    EXPECT_EQ(records[3].kind, ChangeKind::Attach);
+    EXPECT_EQ(records[3].node, 2);
+    EXPECT_EQ(records[3].newVal.get<ObjectId>(), 3);
+    EXPECT_EQ(records[4].property, NodeProperty::Hierarchy);
+    EXPECT_FALSE(records[4].newVal.has_value());
+    EXPECT_EQ(records[5].kind, ChangeKind::Detach);
+    EXPECT_EQ(records[5].oldVal.get<ObjectId>(), 3);
+
+    // Tail from a known position
+    records.clear();
+    EXPECT_TRUE(journal->readSince(4, records));
+    ASSERT_EQ(records.size(), 2);
+    EXPECT_EQ(records[0].sequence, 5);
+
+    // A consumer that falls behind the ring is told so
+    for (int i = 0; i < 10; ++i) child->addTag("T" + std::to_string(i));
+    records.clear();
+    EXPECT_FALSE(journal->readSince(4, records));
+    EXPECT_EQ(records.size(), 8);
+    EXPECT_EQ(records.back().sequence, journal->lastSequence());
+}
+
+TEST(SceneTreeTest, ChangeJournalConcurrentReader) {
+    ChangeJournal journal(64);
+    const uint32_t total = 20000;
+    std::atomic<bool> done{false};
+    std::thread reader([&]() {
+        uint64_t last = 0;
+        std::vector<ChangeRecord> records;
+        while (!done.load() || last < journal.lastSequence()) {
+            records.clear();
+            journal.readSince(last, records);
+            for (const auto& record : records) {
+                // Records are never torn: the payload always matches its sequence number
+                EXPECT_GT(record.sequence, last);
+                EXPECT_EQ(record.node, static_cast<uint32_t>(record.sequence));
+                EXPECT_EQ(record.newVal.get<ObjectId>(), static_cast<uint32_t>(record.sequence) * 3);
+                last = record.sequence;
+            }
+        }
+    });
+    for (uint32_t i = 1; i <= total; ++i) {
+        journal.record(ObjectId(i), ChangeKind::Property, NodeProperty::Hierarchy, PropertyValue(), ObjectId(i * 3));
+    }
+    done.store(true);
+    reader.join();
+    EXPECT_EQ(journal.lastSequence(), total);
+}